@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+    AlignedBuffer.h
+    Created: 19 Oct 2026 10:02:11am
+    Author:  Alperen Kurbetci
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+/*
+ A heap block whose first element sits on an Alignment byte boundary, so SIMD loads
+ (juce::dsp::SIMDRegister::fromRawArray) can be used on it directly.
+ Only allocate() and free() touch the heap, keep them off the audio thread.
+ */
+template <typename ElementType, size_t Alignment = 64>
+
+class AlignedBuffer
+
+{
+public:
+
+    AlignedBuffer() = default;
+
+    void allocate (size_t numElements, bool clearMemory)
+    {
+        _storage.allocate (numElements * sizeof (ElementType) + Alignment, clearMemory);
+
+        auto address = reinterpret_cast<uintptr_t> (_storage.get());
+        _data = reinterpret_cast<ElementType*> ((address + Alignment - 1) & ~(uintptr_t) (Alignment - 1));
+        _size = numElements;
+    }
+
+    void free()
+    {
+        _storage.free();
+        _data = nullptr;
+        _size = 0;
+    }
+
+    void clear() noexcept
+    {
+        if (_data != nullptr)
+            std::fill (_data, _data + _size, ElementType());
+    }
+
+    ElementType* get() const noexcept                     { return _data; }
+    ElementType& operator[] (size_t index) const noexcept { return _data[index]; }
+    size_t size() const noexcept                          { return _size; }
+    size_t getSizeInBytes() const noexcept                { return _size * sizeof (ElementType) + Alignment; }
+
+private:
+
+    juce::HeapBlock<char> _storage;
+    ElementType* _data = nullptr;
+    size_t _size = 0;
+
+    JUCE_DECLARE_NON_COPYABLE (AlignedBuffer)
+};
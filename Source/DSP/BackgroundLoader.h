@@ -0,0 +1,203 @@
+/*
+  ==============================================================================
+
+    BackgroundLoader.h
+    Created: 19 Oct 2026 1:32:18pm
+    Author:  Alperen Kurbetci
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+/*
+ Builds objects from files on its own thread and hands them to the audio thread without locks.
+ Used for everything BuzzBox reads from disk (neural captures, cabinet IRs).
+
+ pending  : built by the loader, not seen by the audio thread yet
+ active   : the one the audio thread is running
+ retired  : swapped out by the audio thread, deleted back here on the loader thread
+ */
+template <typename ObjectType>
+
+class BackgroundLoader : private juce::Thread
+
+{
+public:
+
+    ///Called on the loader thread, returns nullptr and fills errorMessage on failure
+    using Builder = std::function<std::unique_ptr<ObjectType> (const juce::File& file, juce::String& errorMessage)>;
+
+    BackgroundLoader (const juce::String& threadName, Builder builder)
+        : juce::Thread (threadName), _builder (std::move (builder))
+    {
+        startThread();
+    }
+
+    ~BackgroundLoader() override
+    {
+        stopThread (2000);
+
+        delete _pending.exchange (nullptr);
+        delete _retired.exchange (nullptr);
+        delete _active;
+    }
+
+    ///Message thread: queues a file, the previous object keeps running until the new one is ready
+    void loadFile (const juce::File& file)
+    {
+        {
+            const juce::ScopedLock sl (_fileLock);
+            _requestedFile = file;
+            _hasRequest = true;
+        }
+
+        notify();
+    }
+
+    ///Message thread: drops the object, the audio thread lets go of it at its next acquire()
+    void unload()
+    {
+        {
+            const juce::ScopedLock sl (_fileLock);
+            _requestedFile = juce::File();
+            _lastError = {};
+            _hasRequest = true;
+        }
+
+        notify();
+    }
+
+    ///Builds the last requested file again, e.g. when the sample rate it was built for has changed
+    void reload()
+    {
+        auto file = getFile();
+
+        if (file != juce::File())
+            loadFile (file);
+    }
+
+    juce::File getFile() const
+    {
+        const juce::ScopedLock sl (_fileLock);
+        return _requestedFile;
+    }
+
+    juce::String getLastError() const
+    {
+        const juce::ScopedLock sl (_fileLock);
+        return _lastError;
+    }
+
+    ///True from loadFile() until the object has been built and picked up by acquire(), or its build has failed
+    bool isLoading() const
+    {
+        {
+            const juce::ScopedLock sl (_fileLock);
+
+            if (_hasRequest || _building)
+                return true;
+        }
+
+        return hasPending();
+    }
+
+    ///Audio thread: true when a newly built object, or an unload, is waiting to be picked up
+    bool hasPending() const noexcept
+    {
+        return _pending.load (std::memory_order_acquire) != nullptr || _unloadPending.load (std::memory_order_acquire);
+    }
+
+    /*
+     Audio thread: picks up a freshly built object (if allowed and any) and returns the one to use for this block.
+     Never allocates or frees.
+     */
+    ObjectType* acquire (bool allowSwap = true) noexcept
+    {
+        //Only swap when the loader has collected the last retired object, otherwise try again next block
+        if (allowSwap && _retired.load (std::memory_order_acquire) == nullptr)
+        {
+            if (_unloadPending.exchange (false, std::memory_order_acq_rel))
+            {
+                _retired.store (_active, std::memory_order_release);
+                _active = nullptr;
+            }
+            else if (auto* next = _pending.exchange (nullptr, std::memory_order_acq_rel))
+            {
+                _retired.store (_active, std::memory_order_release);
+                _active = next;
+            }
+        }
+
+        return _active;
+    }
+
+    ///Audio thread: the object returned by the last acquire()
+    ObjectType* getActive() const noexcept { return _active; }
+
+private:
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            delete _retired.exchange (nullptr, std::memory_order_acq_rel);
+
+            juce::File file;
+            bool requested = false;
+
+            {
+                const juce::ScopedLock sl (_fileLock);
+
+                if (_hasRequest)
+                {
+                    file = _requestedFile;
+                    requested = true;
+                    _hasRequest = false;
+                    _building = true;
+                }
+            }
+
+            //An unload: whatever was built and not picked up goes as well, the audio thread drops the active one
+            if (requested && file == juce::File())
+            {
+                const juce::ScopedLock sl (_fileLock);
+                delete _pending.exchange (nullptr, std::memory_order_acq_rel);
+                _unloadPending.store (true, std::memory_order_release);
+                _building = false;
+            }
+            else if (requested)
+            {
+                juce::String error;
+                auto object = _builder (file, error);
+
+                const juce::ScopedLock sl (_fileLock);
+                _lastError = error;
+
+                //An object that was never picked up is simply replaced
+                if (object != nullptr)
+                    delete _pending.exchange (object.release(), std::memory_order_acq_rel);
+
+                _building = false;
+            }
+
+            wait (250);
+        }
+    }
+
+    Builder _builder;
+
+    std::atomic<ObjectType*> _pending { nullptr };
+    std::atomic<ObjectType*> _retired { nullptr };
+    std::atomic<bool> _unloadPending { false };
+    ObjectType* _active = nullptr;
+
+    juce::CriticalSection _fileLock;
+    juce::File _requestedFile;
+    juce::String _lastError;
+    bool _hasRequest = false;
+    bool _building = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BackgroundLoader)
+};
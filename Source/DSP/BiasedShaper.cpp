@@ -0,0 +1,36 @@
+/*
+  ==============================================================================
+
+    BiasedShaper.cpp
+    Created: 20 Oct 2026 4:21:36am
+    Author:  Alperen Kurbetci
+
+  ==============================================================================
+*/
+
+#include "BiasedShaper.h"
+
+template <typename SampleType>
+
+BiasedShaper<SampleType>::BiasedShaper()
+{
+
+}
+
+template <typename SampleType>
+
+void BiasedShaper<SampleType>::prepare (int numChannels)
+{
+    _numChannels = (size_t) numChannels;
+    _previous.allocate (_numChannels, true);
+}
+
+template <typename SampleType>
+
+void BiasedShaper<SampleType>::reset()
+{
+    _previous.clear();
+}
+
+template class BiasedShaper<float>;
+template class BiasedShaper<double>;
@@ -0,0 +1,217 @@
+/*
+  ==============================================================================
+
+    BiasedShaper.h
+    Created: 20 Oct 2026 4:21:36am
+    Author:  Alperen Kurbetci
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "AlignedBuffer.h"
+
+/*
+ Static curves run around a bias point, for the wavefolder and the triode:
+
+     y = f (x + b) - f (b)
+
+ The bias moves the operating point off the middle of the curve, so both halves of the wave
+ see different slopes: even harmonics, and a dc offset that moves with the level (the
+ distortion takes it out after the wet signal). Silence stays silent.
+
+     Sine fold      f = sin (pi/2 x),                    F = -2/pi sin (pi/2 (x + 1))
+     Triangle fold  f = 1 - |v|,                         F = v - v |v| / 2
+                    v = (x + 1) mod 4 - 2
+     Triode         f = x / sqrt (1 + c^2 x^2),          F = x^2 / (sqrt (1 + c^2 x^2) + 1)
+                    c = cGrid above zero, cCutoff below
+
+ The folds fold once per 2 of input, so the drive sets the number of folds. The triode clips
+ hard where the grid conducts and runs into cutoff slowly on the other side.
+
+ Every curve has the closed form antiderivative F, each output sample is the first order
+ antiderivative anti-aliasing (ADAA) average of f between the last two inputs,
+
+     y[n] = (F (x[n]) - F (x[n-1])) / (x[n] - x[n-1])
+
+ or f at their midpoint where the two are too close for the difference to be exact. It halves
+ the aliasing of every fold on top of the oversampling, at the cost of half a sample of delay
+ and a gentle roll off near Nyquist. The kernels are branch free: the sine is a polynomial
+ after range reduction by the triangle fold, the sign and the near-equal cases are selects,
+ and the block runs backwards so no sample depends on one already written, which lets the
+ compiler vectorise it (GCC only with -fno-trapping-math, and for the triode -fno-math-errno).
+ The state is the last input of each channel.
+ */
+template <typename SampleType>
+
+class BiasedShaper
+
+{
+public:
+
+    enum class Curve
+    {
+        cSineFold,
+        cTriangleFold,
+        cTriode
+    };
+
+    BiasedShaper();
+
+    void prepare (int numChannels);
+
+    void reset();
+
+    void setCurve (Curve newCurve) noexcept { _curve = newCurve; }
+
+    ///Operating point, -1 - 1
+    void setBias (SampleType newBias) noexcept { _bias = juce::jlimit (SampleType (-1), SampleType (1), newBias); }
+
+    size_t getMemoryFootprintBytes() const noexcept { return _previous.getSizeInBytes(); }
+
+    ///The driven signal in place
+    void process (SampleType* samples, int numSamples, int channel) noexcept
+    {
+        if ((size_t) channel >= _numChannels || numSamples <= 0)
+            return;
+
+        switch (_curve)
+        {
+            case Curve::cSineFold:     processWith<Curve::cSineFold> (samples, numSamples, (size_t) channel); break;
+            case Curve::cTriangleFold: processWith<Curve::cTriangleFold> (samples, numSamples, (size_t) channel); break;
+            case Curve::cTriode:       processWith<Curve::cTriode> (samples, numSamples, (size_t) channel); break;
+        }
+    }
+
+    ///One driven sample, for callers that run several stages per sample
+    SampleType processSample (SampleType x, int channel) noexcept
+    {
+        if ((size_t) channel >= _numChannels)
+            return x;
+
+        auto& previous = _previous[(size_t) channel];
+        const auto last = previous;
+        previous = x;
+
+        switch (_curve)
+        {
+            case Curve::cSineFold:     return getAverage<Curve::cSineFold> (x, last, _bias, shape<Curve::cSineFold> (_bias));
+            case Curve::cTriangleFold: return getAverage<Curve::cTriangleFold> (x, last, _bias, shape<Curve::cTriangleFold> (_bias));
+            case Curve::cTriode:       return getAverage<Curve::cTriode> (x, last, _bias, shape<Curve::cTriode> (_bias));
+        }
+
+        return x;
+    }
+
+private:
+
+    template <Curve curve>
+    void processWith (SampleType* samples, int numSamples, size_t channel) noexcept
+    {
+        const auto bias = _bias;
+        const auto offset = shape<curve> (bias);
+
+        const auto first = _previous[channel];
+        _previous[channel] = samples[numSamples - 1];
+
+        //Backwards, the input before each sample is still unwritten when it is read
+        for (int i = numSamples - 1; i > 0; --i)
+            samples[i] = getAverage<curve> (samples[i], samples[i - 1], bias, offset);
+
+        samples[0] = getAverage<curve> (samples[0], first, bias, offset);
+    }
+
+    /*
+     Mean of the biased curve between two inputs. Both forms are worked out and one is selected
+     by a 0 / 1 weight, a ternary the compiler would turn back into a branch around the division.
+     */
+    template <Curve curve>
+    static SampleType getAverage (SampleType x, SampleType last, SampleType bias, SampleType offset) noexcept
+    {
+        const auto difference = x - last;
+        const auto close = static_cast<SampleType> (std::abs (difference) < tolerance);
+
+        const auto slope = (antiderivative<curve> (x + bias) - antiderivative<curve> (last + bias)) / (difference + close * (SampleType (1) - difference));
+        const auto middle = shape<curve> (SampleType (0.5) * (x + last) + bias);
+
+        return slope + close * (middle - slope) - offset;
+    }
+
+    template <Curve curve>
+    static SampleType shape (SampleType x) noexcept
+    {
+        if constexpr (curve == Curve::cSineFold)
+            return halfPiSine (triangle (x));
+        else if constexpr (curve == Curve::cTriangleFold)
+            return triangle (x);
+        else
+            return x / std::sqrt (SampleType (1) + square (getTriodeScale (x) * x));
+    }
+
+    template <Curve curve>
+    static SampleType antiderivative (SampleType x) noexcept
+    {
+        if constexpr (curve == Curve::cSineFold)
+        {
+            return -twoOverPi * halfPiSine (triangle (x + SampleType (1)));
+        }
+        else if constexpr (curve == Curve::cTriangleFold)
+        {
+            const auto v = foldPhase (x);
+            return v - SampleType (0.5) * v * std::abs (v);
+        }
+        else
+        {
+            return x * x / (std::sqrt (SampleType (1) + square (getTriodeScale (x) * x)) + SampleType (1));
+        }
+    }
+
+    static SampleType square (SampleType x) noexcept { return x * x; }
+
+    ///(x + 1) mod 4 - 2, -2 - 2. The floor is a truncation and a correction, std::floor only vectorises from SSE4.1 on
+    static SampleType foldPhase (SampleType x) noexcept
+    {
+        const auto u = x + SampleType (1);
+        const auto periods = juce::jlimit (SampleType (-maxPeriods), SampleType (maxPeriods), u * SampleType (0.25));
+        const auto truncated = static_cast<SampleType> (static_cast<int> (periods));
+        const auto floored = truncated - static_cast<SampleType> (truncated > periods);
+
+        return u - SampleType (4) * floored - SampleType (2);
+    }
+
+    ///Period 4 triangle through the origin with slope 1 there, -1 - 1
+    static SampleType triangle (SampleType x) noexcept { return SampleType (1) - std::abs (foldPhase (x)); }
+
+    ///sin (pi/2 t) for t in -1 - 1, Taylor to t^13 (below 1e-9 off, the ADAA differences need it)
+    static SampleType halfPiSine (SampleType t) noexcept
+    {
+        const auto t2 = t * t;
+
+        return t * (SampleType (1.5707963267948966) + t2 * (SampleType (-0.6459640975062462) + t2 * (SampleType (0.0796926262461670)
+             + t2 * (SampleType (-0.0046817541353187) + t2 * (SampleType (0.0001604411847874) + t2 * (SampleType (-0.0000035988432352)
+             + t2 * SampleType (0.0000000569217292)))))));
+    }
+
+    static SampleType getTriodeScale (SampleType x) noexcept { return triodeCutoff + (triodeGrid - triodeCutoff) * static_cast<SampleType> (x > SampleType (0)); }
+
+  //Curve scale above and below zero: the grid conducts early, the cutoff comes slowly
+    static constexpr SampleType triodeGrid = SampleType (2.5);
+    static constexpr SampleType triodeCutoff = SampleType (1);
+
+    static constexpr SampleType twoOverPi = SampleType (2) / juce::MathConstants<SampleType>::pi;
+
+  //Far past any drive, keeps the truncation inside an int
+    static constexpr int maxPeriods = 1 << 20;
+
+  //Inputs closer than this take the midpoint, the difference of F loses too much below it
+    static constexpr SampleType tolerance = SampleType (1.0e-3);
+
+    Curve _curve = Curve::cSineFold;
+    SampleType _bias = SampleType (0);
+
+    AlignedBuffer<SampleType> _previous;
+    size_t _numChannels = 0;
+
+    JUCE_DECLARE_NON_COPYABLE (BiasedShaper)
+};
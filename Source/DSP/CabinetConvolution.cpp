@@ -0,0 +1,592 @@
+/*
+  ==============================================================================
+
+    CabinetConvolution.cpp
+    Created: 19 Oct 2026 1:58:47pm
+    Author:  Alperen Kurbetci
+
+  ==============================================================================
+*/
+
+#include "CabinetConvolution.h"
+
+namespace
+{
+    //acc += a * b over interleaved complex bins, written out so no compiler falls back to __mulsc3
+    inline void multiplyAccumulate (float* acc, const float* a, const float* b, int numBins) noexcept
+    {
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            const auto re = 2 * bin, im = 2 * bin + 1;
+            acc[re] += a[re] * b[re] - a[im] * b[im];
+            acc[im] += a[re] * b[im] + a[im] * b[re];
+        }
+    }
+
+    //Spectrum of blockSize taps zero padded to twice the block size
+    void transformPartition (const juce::dsp::FFT& fft, const float* taps, int numTaps, int blockSize, float* scratch, float* spectrum)
+    {
+        std::fill (scratch, scratch + 4 * blockSize, 0.0f);
+        std::copy (taps, taps + numTaps, scratch);
+
+        fft.performRealOnlyForwardTransform (scratch, true);
+        std::copy (scratch, scratch + 2 * (blockSize + 1), spectrum);
+    }
+}
+
+//==============================================================================
+CabinetImpulse::CabinetImpulse (const juce::AudioBuffer<float>& impulse, double sampleRate)
+    : _sampleRate (sampleRate), _numChannels (impulse.getNumChannels()), _length (impulse.getNumSamples())
+{
+    _numMidPartitions  = juce::jlimit (0, maxMidPartitions, (juce::jmin (_length, tailStart) - headSize + midBlockSize - 1) / midBlockSize);
+    _numTailPartitions = juce::jmax (0, (_length - tailStart + tailBlockSize - 1) / tailBlockSize);
+
+    _headTaps.allocate ((size_t) (_numChannels * headSize), true);
+    _midSpectra.allocate ((size_t) (_numChannels * _numMidPartitions * midBins * 2), true);
+    _tailSpectra.allocate ((size_t) (_numChannels * _numTailPartitions * tailBins * 2), true);
+
+    juce::dsp::FFT midFFT (midFFTOrder), tailFFT (tailFFTOrder);
+    std::vector<float> scratch ((size_t) (4 * tailBlockSize));
+
+    for (int channel = 0; channel < _numChannels; ++channel)
+    {
+        const auto* taps = impulse.getReadPointer (channel);
+
+        std::copy (taps, taps + juce::jmin (headSize, _length), _headTaps.get() + channel * headSize);
+
+        for (int p = 0; p < _numMidPartitions; ++p)
+        {
+            const auto offset = headSize + p * midBlockSize;
+            transformPartition (midFFT, taps + offset, juce::jmin (midBlockSize, _length - offset),
+                                midBlockSize, scratch.data(), const_cast<float*> (getMidSpectrum (channel, p)));
+        }
+
+        for (int p = 0; p < _numTailPartitions; ++p)
+        {
+            const auto offset = tailStart + p * tailBlockSize;
+            transformPartition (tailFFT, taps + offset, juce::jmin (tailBlockSize, _length - offset),
+                                tailBlockSize, scratch.data(), const_cast<float*> (getTailSpectrum (channel, p)));
+        }
+    }
+}
+
+const float* CabinetImpulse::getHeadTaps (int channel) const noexcept
+{
+    return _headTaps.get() + channel * headSize;
+}
+
+const float* CabinetImpulse::getMidSpectrum (int channel, int partition) const noexcept
+{
+    return _midSpectra.get() + (channel * _numMidPartitions + partition) * midBins * 2;
+}
+
+const float* CabinetImpulse::getTailSpectrum (int channel, int partition) const noexcept
+{
+    return _tailSpectra.get() + (channel * _numTailPartitions + partition) * tailBins * 2;
+}
+
+size_t CabinetImpulse::getMemoryFootprintBytes() const noexcept
+{
+    return sizeof (*this) + _headTaps.getSizeInBytes() + _midSpectra.getSizeInBytes() + _tailSpectra.getSizeInBytes();
+}
+
+//==============================================================================
+CabinetEngine::CabinetEngine (std::shared_ptr<const CabinetImpulse> impulse, int numChannels)
+    : _impulse (std::move (impulse)), _numChannels (numChannels)
+{
+    using IR = CabinetImpulse;
+
+    _numMidPartitions  = _impulse->getNumMidPartitions();
+    _numTailPartitions = _impulse->getNumTailPartitions();
+
+    const auto channels = (size_t) _numChannels;
+
+    _headHistory.allocate (channels * 2 * IR::headSize, true);
+
+    _midWindow.allocate (channels * 2 * IR::midBlockSize, true);
+    _midOutput.allocate (channels * IR::midBlockSize, true);
+    _midDelayLine.allocate (channels * (size_t) juce::jmax (1, _numMidPartitions) * IR::midBins * 2, true);
+    _midScratch.allocate (4 * IR::midBlockSize + 2 * IR::midBins, true);
+
+    if (_numTailPartitions > 0)
+    {
+        _tailInput.allocate (2 * channels * IR::tailBlockSize, true);
+        _tailOutput.allocate (2 * channels * IR::tailBlockSize, true);
+        _tailWindow.allocate (channels * 2 * IR::tailBlockSize, true);
+        _tailDelayLine.allocate (channels * (size_t) _numTailPartitions * IR::tailBins * 2, true);
+        _tailScratch.allocate (4 * IR::tailBlockSize + 2 * IR::tailBins, true);
+    }
+}
+
+void CabinetEngine::reset() noexcept
+{
+    /*
+     The tail thread may be inside this engine, so its window and delay line are left to it: it
+     clears them before the first block from here on, and skips the blocks still pending.
+     The block being filled restarts, its input buffer only if the tail thread is done with it.
+     */
+    _headHistory.clear();
+    _midWindow.clear();
+    _midOutput.clear();
+    _midDelayLine.clear();
+
+    _headPos = _midPos = _midDelayPos = 0;
+    _tailPos = 0;
+    _tailOutputValid = false;
+    _tailInputValid = _tailCompleted.load (std::memory_order_acquire) >= _tailBlockCount - 1;
+
+    _tailResetBlock.store (_tailBlockCount, std::memory_order_release);
+}
+
+int CabinetEngine::processSegment (float* const* channels, int numChannels, int start, int numSamples) noexcept
+{
+    using IR = CabinetImpulse;
+
+    const auto count = juce::jmin (numSamples, IR::midBlockSize - _midPos);
+    const auto hasTail = _numTailPartitions > 0;
+
+    //Filling block n, playing block n - 2 (see submitTailBlock)
+    const auto slot = _tailBlockCount & 1;
+
+    for (int channel = 0; channel < juce::jmin (numChannels, _numChannels); ++channel)
+    {
+        auto* samples = channels[channel] + start;
+
+        const auto* taps = _impulse->getHeadTaps (juce::jmin (channel, _impulse->getNumChannels() - 1));
+        auto* history    = _headHistory.get() + channel * 2 * IR::headSize;
+        auto* midWindow  = _midWindow.get() + channel * 2 * IR::midBlockSize + IR::midBlockSize + _midPos;
+        auto* midOutput  = _midOutput.get() + channel * IR::midBlockSize + _midPos;
+
+        auto* tailInput  = hasTail && _tailInputValid ? _tailInput.get() + (slot * _numChannels + channel) * IR::tailBlockSize + _tailPos : nullptr;
+        auto* tailOutput = hasTail ? _tailOutput.get() + (slot * _numChannels + channel) * IR::tailBlockSize + _tailPos : nullptr;
+
+        auto headPos = _headPos;
+
+        for (int i = 0; i < count; ++i)
+        {
+            const auto x = samples[i];
+
+            //history[headPos ...] holds x[n], x[n - 1], ... so the taps run forwards
+            headPos = (headPos + IR::headSize - 1) & (IR::headSize - 1);
+            history[headPos] = history[headPos + IR::headSize] = x;
+
+            auto y = 0.0f;
+
+            for (int k = 0; k < IR::headSize; ++k)
+                y += taps[k] * history[headPos + k];
+
+            midWindow[i] = x;
+            y += midOutput[i];
+
+            if (tailInput != nullptr)
+                tailInput[i] = x;
+
+            if (hasTail && _tailOutputValid)
+                y += tailOutput[i];
+
+            samples[i] = y;
+        }
+
+        if (channel == juce::jmin (numChannels, _numChannels) - 1)
+            _headPos = headPos;
+    }
+
+    _midPos += count;
+
+    if (hasTail)
+        _tailPos += count;
+
+    if (_midPos == IR::midBlockSize)
+    {
+        processMidBlock();
+        _midPos = 0;
+    }
+
+    return count;
+}
+
+void CabinetEngine::processMidBlock() noexcept
+{
+    using IR = CabinetImpulse;
+    constexpr int blockSize = IR::midBlockSize;
+
+    auto* scratch = _midScratch.get();
+    auto* accumulator = scratch + 4 * blockSize;
+
+    for (int channel = 0; channel < _numChannels; ++channel)
+    {
+        auto* window = _midWindow.get() + channel * 2 * blockSize;
+        auto* output = _midOutput.get() + channel * blockSize;
+
+        if (_numMidPartitions > 0)
+        {
+            //Overlap-save: transform the last two blocks, keep the second half of the result
+            std::copy (window, window + 2 * blockSize, scratch);
+            std::fill (scratch + 2 * blockSize, scratch + 4 * blockSize, 0.0f);
+            _midFFT.performRealOnlyForwardTransform (scratch, true);
+
+            auto* delayLine = _midDelayLine.get() + channel * _numMidPartitions * IR::midBins * 2;
+            std::copy (scratch, scratch + 2 * IR::midBins, delayLine + _midDelayPos * IR::midBins * 2);
+
+            std::fill (accumulator, accumulator + 2 * IR::midBins, 0.0f);
+
+            const auto irChannel = juce::jmin (channel, _impulse->getNumChannels() - 1);
+
+            for (int p = 0; p < _numMidPartitions; ++p)
+            {
+                const auto index = (_midDelayPos - p + _numMidPartitions) % _numMidPartitions;
+                multiplyAccumulate (accumulator, delayLine + index * IR::midBins * 2,
+                                    _impulse->getMidSpectrum (irChannel, p), IR::midBins);
+            }
+
+            std::copy (accumulator, accumulator + 2 * IR::midBins, scratch);
+            _midFFT.performRealOnlyInverseTransform (scratch);
+            std::copy (scratch + blockSize, scratch + 2 * blockSize, output);
+        }
+
+        std::copy (window + blockSize, window + 2 * blockSize, window);
+    }
+
+    if (_numMidPartitions > 0)
+        _midDelayPos = (_midDelayPos + 1) % _numMidPartitions;
+}
+
+void CabinetEngine::submitTailBlock() noexcept
+{
+    //Published by the release below
+    if (_tailInputValid)
+        _tailFilled[(size_t) (_tailBlockCount & 1)].store (_tailBlockCount, std::memory_order_relaxed);
+
+    _tailPos = 0;
+    _tailSubmitted.store (++_tailBlockCount, std::memory_order_release);
+}
+
+bool CabinetEngine::prepareDueTailBlock (bool computeIfLate) noexcept
+{
+    /*
+     Block n - 2 plays while block n fills: it covers IR offsets from tailStart = 2 * tailBlockSize,
+     so it is due one block after its input was complete. Once it is done the tail thread is past
+     the buffers of block n as well, so both halves of the swap hang on the same check.
+     */
+    const auto due = _tailBlockCount - 1;
+
+    if (computeIfLate)
+        while (_tailCompleted.load (std::memory_order_acquire) < due)
+            if (! processPendingTail())
+                std::this_thread::yield();
+
+    const auto ready = _tailCompleted.load (std::memory_order_acquire) >= due;
+
+    _tailInputValid = ready;
+    _tailOutputValid = ready && due - 1 >= _tailResetBlock.load (std::memory_order_relaxed);
+
+    return ready;
+}
+
+bool CabinetEngine::processPendingTail() noexcept
+{
+    if (_tailBusy.exchange (true, std::memory_order_acquire))
+        return false;
+
+    for (auto done = _tailCompleted.load (std::memory_order_relaxed);
+         done < _tailSubmitted.load (std::memory_order_acquire); ++done)
+    {
+        //A reset since the last block: start from silence, the blocks before it are skipped
+        const auto resetBlock = _tailResetBlock.load (std::memory_order_acquire);
+
+        if (resetBlock != _tailClearedBlock)
+        {
+            _tailWindow.clear();
+            _tailDelayLine.clear();
+            _tailDelayPos = 0;
+            _tailClearedBlock = resetBlock;
+        }
+
+        if (done >= resetBlock)
+            processTailBlock (done);
+
+        _tailCompleted.store (done + 1, std::memory_order_release);
+    }
+
+    _tailBusy.store (false, std::memory_order_release);
+    return true;
+}
+
+void CabinetEngine::processTailBlock (int blockIndex) noexcept
+{
+    using IR = CabinetImpulse;
+    constexpr int blockSize = IR::tailBlockSize;
+
+    const auto slot = blockIndex & 1;
+    const auto filled = _tailFilled[(size_t) slot].load (std::memory_order_relaxed) == blockIndex;
+
+    auto* scratch = _tailScratch.get();
+    auto* accumulator = scratch + 4 * blockSize;
+
+    for (int channel = 0; channel < _numChannels; ++channel)
+    {
+        const auto* input = _tailInput.get() + (slot * _numChannels + channel) * blockSize;
+        auto* output      = _tailOutput.get() + (slot * _numChannels + channel) * blockSize;
+        auto* window      = _tailWindow.get() + channel * 2 * blockSize;
+        auto* delayLine   = _tailDelayLine.get() + channel * _numTailPartitions * IR::tailBins * 2;
+
+        std::copy (window + blockSize, window + 2 * blockSize, window);
+
+        if (filled)
+            std::copy (input, input + blockSize, window + blockSize);
+        else
+            std::fill (window + blockSize, window + 2 * blockSize, 0.0f);
+
+        std::copy (window, window + 2 * blockSize, scratch);
+        std::fill (scratch + 2 * blockSize, scratch + 4 * blockSize, 0.0f);
+        _tailFFT.performRealOnlyForwardTransform (scratch, true);
+        std::copy (scratch, scratch + 2 * IR::tailBins, delayLine + _tailDelayPos * IR::tailBins * 2);
+
+        std::fill (accumulator, accumulator + 2 * IR::tailBins, 0.0f);
+
+        const auto irChannel = juce::jmin (channel, _impulse->getNumChannels() - 1);
+
+        for (int p = 0; p < _numTailPartitions; ++p)
+        {
+            const auto index = (_tailDelayPos - p + _numTailPartitions) % _numTailPartitions;
+            multiplyAccumulate (accumulator, delayLine + index * IR::tailBins * 2,
+                                _impulse->getTailSpectrum (irChannel, p), IR::tailBins);
+        }
+
+        std::copy (accumulator, accumulator + 2 * IR::tailBins, scratch);
+        _tailFFT.performRealOnlyInverseTransform (scratch);
+        std::copy (scratch + blockSize, scratch + 2 * blockSize, output);
+    }
+
+    _tailDelayPos = (_tailDelayPos + 1) % _numTailPartitions;
+}
+
+size_t CabinetEngine::getMemoryFootprintBytes() const noexcept
+{
+    return sizeof (*this)
+         + _headHistory.getSizeInBytes()
+         + _midWindow.getSizeInBytes() + _midOutput.getSizeInBytes() + _midDelayLine.getSizeInBytes() + _midScratch.getSizeInBytes()
+         + _tailInput.getSizeInBytes() + _tailOutput.getSizeInBytes() + _tailWindow.getSizeInBytes()
+         + _tailDelayLine.getSizeInBytes() + _tailScratch.getSizeInBytes();
+}
+
+//==============================================================================
+CabinetTailThread::CabinetTailThread() : juce::Thread ("BuzzBox Cabinet Tail")
+{
+    //Above the loaders and the UI, the audio thread plays a late tail block without it
+    startThread (juce::Thread::Priority::high);
+}
+
+CabinetTailThread::~CabinetTailThread()
+{
+    stopThread (2000);
+}
+
+void CabinetTailThread::addConvolution (CabinetConvolution* convolution)
+{
+    const juce::ScopedLock sl (_lock);
+    _convolutions.addIfNotAlreadyThere (convolution);
+}
+
+void CabinetTailThread::removeConvolution (CabinetConvolution* convolution)
+{
+    //Waits for the current pass, so the convolution is never touched after this returns
+    const juce::ScopedLock sl (_lock);
+    _convolutions.removeFirstMatchingValue (convolution);
+}
+
+void CabinetTailThread::run()
+{
+    while (! threadShouldExit())
+    {
+        if (_pending.exchange (false, std::memory_order_acquire))
+        {
+            const juce::ScopedLock sl (_lock);
+
+            for (auto* convolution : _convolutions)
+                convolution->processPendingTail();
+        }
+
+        //Polled, the audio thread never signals; stopThread() still wakes it straight away
+        wait (pollIntervalMs);
+    }
+}
+
+//==============================================================================
+CabinetConvolution::CabinetConvolution()
+    : _loader ("BuzzBox IR Loader", [this] (const juce::File& file, juce::String& error) { return buildEngine (file, error); })
+{
+    _tailThread->addConvolution (this);
+}
+
+CabinetConvolution::~CabinetConvolution()
+{
+    _tailThread->removeConvolution (this);
+}
+
+void CabinetConvolution::prepare (const juce::dsp::ProcessSpec& spec)
+{
+    _maxBlockSize = (int) spec.maximumBlockSize;
+    _channelPointers.resize (spec.numChannels);
+    _floatBuffer.setSize ((int) spec.numChannels, _maxBlockSize);
+
+    const bool formatChanged = spec.sampleRate != _sampleRate.load() || (int) spec.numChannels != _numChannels.load();
+
+    _sampleRate.store (spec.sampleRate);
+    _numChannels.store ((int) spec.numChannels);
+    _tailOverruns.store (0);
+
+    //The IR is rebuilt for the new rate in the background, the old one keeps playing meanwhile
+    if (formatChanged)
+        _loader.reload();
+
+    reset();
+}
+
+void CabinetConvolution::reset() noexcept
+{
+    if (auto* engine = _loader.getActive())
+        engine->reset();
+}
+
+void CabinetConvolution::loadImpulseResponse (const juce::File& file)
+{
+    _loader.loadFile (file);
+}
+
+void CabinetConvolution::clearImpulseResponse()
+{
+    _loader.unload();
+}
+
+CabinetEngine* CabinetConvolution::acquireEngine() noexcept
+{
+    if (! _loader.hasPending())
+        return _loader.getActive();
+
+    //Dekker style hand over: either the tail thread sees no engine, or we see it inside and wait a block
+    _tailEngine.store (nullptr);
+
+    auto* engine = _tailThreadInside.load() ? _loader.getActive() : _loader.acquire();
+
+    _tailEngine.store (engine);
+    return engine;
+}
+
+void CabinetConvolution::submitTailBlock (CabinetEngine& engine) noexcept
+{
+    engine.submitTailBlock();
+    _tailThread->wakeUp();
+
+    if (! engine.prepareDueTailBlock (_nonRealtime.load (std::memory_order_relaxed)))
+        _tailOverruns.fetch_add (1, std::memory_order_relaxed);
+}
+
+void CabinetConvolution::processPendingTail() noexcept
+{
+    _tailThreadInside.store (true);
+
+    if (auto* engine = _tailEngine.load())
+        engine->processPendingTail();
+
+    _tailThreadInside.store (false);
+}
+
+std::unique_ptr<CabinetEngine> CabinetConvolution::buildEngine (const juce::File& file, juce::String& errorMessage)
+{
+    const auto sampleRate = _sampleRate.load();
+
+    if (sampleRate <= 0.0)
+    {
+        errorMessage = "Waiting for the audio device";
+        return nullptr;
+    }
+
+    //Every instance that loads the same file at the same rate ends up on the same impulse
+    const auto fileKey = SharedResourceCache::getFileKey (file);
+
+    if (fileKey != _decodedKey)
+    {
+        _decoded = _sharedResources->getOrBuild<DecodedFile> ("Impulse file/" + fileKey,
+                                                              [&file, &errorMessage] { return decodeFile (file, errorMessage); });
+        _decodedKey = _decoded != nullptr ? fileKey : juce::String();
+
+        if (_decoded == nullptr)
+            return nullptr;
+    }
+
+    auto impulse = _sharedResources->getOrBuild<CabinetImpulse> ("Cabinet impulse/" + fileKey + "/" + juce::String (sampleRate),
+                                                                 [this, sampleRate] { return buildImpulse (*_decoded, sampleRate); });
+
+    _impulseSeconds.store (impulse->getLength() / sampleRate);
+
+    auto engine = std::make_unique<CabinetEngine> (std::move (impulse), _numChannels.load());
+    _engineBytes.store (engine->getMemoryFootprintBytes());
+
+    return engine;
+}
+
+std::shared_ptr<const CabinetConvolution::DecodedFile> CabinetConvolution::decodeFile (const juce::File& file, juce::String& errorMessage)
+{
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (file));
+
+    if (reader == nullptr)
+    {
+        errorMessage = "Can not read impulse response: " + file.getFullPathName();
+        return nullptr;
+    }
+
+    const auto length = (int) juce::jmin (reader->lengthInSamples, (juce::int64) (maxImpulseSeconds * reader->sampleRate));
+    const auto numChannels = juce::jmin (2, (int) reader->numChannels);
+
+    auto decoded = std::make_shared<DecodedFile>();
+    decoded->buffer.setSize (numChannels, length);
+    reader->read (&decoded->buffer, 0, length, 0, true, numChannels > 1);
+    decoded->sampleRate = reader->sampleRate;
+
+    return decoded;
+}
+
+std::shared_ptr<const CabinetImpulse> CabinetConvolution::buildImpulse (const DecodedFile& decoded, double sampleRate)
+{
+    const auto ratio = decoded.sampleRate / sampleRate;
+    const auto numChannels = decoded.buffer.getNumChannels();
+    const auto inputLength = decoded.buffer.getNumSamples();
+    const auto outputLength = juce::jmax (1, (int) std::ceil (inputLength / ratio));
+
+    juce::AudioBuffer<float> impulse (numChannels, outputLength);
+
+    if (ratio == 1.0)
+    {
+        impulse.makeCopyOf (decoded.buffer);
+    }
+    else
+    {
+        //Zero padded so the interpolator can read past the end of the file
+        juce::AudioBuffer<float> padded (numChannels, inputLength + 64);
+        padded.clear();
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            padded.copyFrom (channel, 0, decoded.buffer, channel, 0, inputLength);
+
+            juce::WindowedSincInterpolator interpolator;
+            interpolator.process (ratio, padded.getReadPointer (channel), impulse.getWritePointer (channel), outputLength);
+        }
+    }
+
+    //Unity power gain, so swapping cabinets does not jump in level
+    auto energy = 0.0;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        for (int i = 0; i < outputLength; ++i)
+            energy += juce::square ((double) impulse.getSample (channel, i));
+
+    if (energy > 0.0)
+        impulse.applyGain ((float) (1.0 / std::sqrt (energy / numChannels)));
+
+    return std::make_shared<const CabinetImpulse> (impulse, sampleRate);
+}
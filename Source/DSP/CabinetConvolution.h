@@ -0,0 +1,345 @@
+/*
+  ==============================================================================
+
+    CabinetConvolution.h
+    Created: 19 Oct 2026 1:58:47pm
+    Author:  Alperen Kurbetci
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "AlignedBuffer.h"
+#include "BackgroundLoader.h"
+#include "SharedResourceCache.h"
+
+/*
+ Cabinet stage: zero latency non-uniform partitioned convolution.
+
+ The impulse response is split in three parts
+   [0, headSize)            direct FIR on the audio thread, gives the zero latency
+   [headSize, tailStart)    uniform FFT partitions of headSize samples, on the audio thread
+   [tailStart, end)         uniform FFT partitions of tailBlockSize samples, on a background thread
+
+ A tail block is handed over as soon as its input is complete and is only needed tailBlockSize
+ samples later, that is the time the background thread has to finish it. The audio thread never
+ waits for it: a late block plays without its tail and counts as an overrun. Offline renders are
+ not bound to real time, there the audio thread computes a late block itself.
+ */
+
+//==============================================================================
+///Immutable, resampled and transformed IR. Built off the audio thread
+class CabinetImpulse
+
+{
+public:
+
+    static constexpr int headSize        = 64;
+    static constexpr int midBlockSize    = headSize;
+    static constexpr int midFFTOrder     = 7;
+    static constexpr int tailBlockSize   = 1024;
+    static constexpr int tailFFTOrder    = 11;
+    static constexpr int tailStart       = 2 * tailBlockSize;
+    static constexpr int maxMidPartitions = (tailStart - headSize) / midBlockSize;
+
+    //Bins of a real FFT of twice the block size, stored as interleaved re/im floats
+    static constexpr int midBins  = midBlockSize + 1;
+    static constexpr int tailBins = tailBlockSize + 1;
+
+    CabinetImpulse (const juce::AudioBuffer<float>& impulse, double sampleRate);
+
+    double getSampleRate() const noexcept       { return _sampleRate; }
+    int getNumChannels() const noexcept         { return _numChannels; }
+    int getLength() const noexcept              { return _length; }
+    int getNumMidPartitions() const noexcept    { return _numMidPartitions; }
+    int getNumTailPartitions() const noexcept   { return _numTailPartitions; }
+
+    const float* getHeadTaps (int channel) const noexcept;
+    const float* getMidSpectrum (int channel, int partition) const noexcept;
+    const float* getTailSpectrum (int channel, int partition) const noexcept;
+
+    size_t getMemoryFootprintBytes() const noexcept;
+
+private:
+
+    double _sampleRate = 0.0;
+    int _numChannels = 0, _length = 0;
+    int _numMidPartitions = 0, _numTailPartitions = 0;
+
+    AlignedBuffer<float> _headTaps, _midSpectra, _tailSpectra;
+
+    JUCE_DECLARE_NON_COPYABLE (CabinetImpulse)
+};
+
+//==============================================================================
+///The running state for one IR: delay lines, overlap windows and the tail hand over
+class CabinetEngine
+
+{
+public:
+
+    CabinetEngine (std::shared_ptr<const CabinetImpulse> impulse, int numChannels);
+
+    const CabinetImpulse& getImpulse() const noexcept { return *_impulse; }
+    int getNumChannels() const noexcept { return _numChannels; }
+
+    ///Clears the audio thread's delay lines now, the tail's ones before the next tail block is computed
+    void reset() noexcept;
+
+    ///Audio thread: convolves up to the next partition boundary in place, returns the samples consumed
+    int processSegment (float* const* channels, int numChannels, int start, int numSamples) noexcept;
+
+    ///Audio thread: true when a tail block has just been filled and must be handed over
+    bool isTailBlockComplete() const noexcept { return _numTailPartitions > 0 && _tailPos == CabinetImpulse::tailBlockSize; }
+
+    ///Audio thread: hands the filled tail block over to whoever computes it
+    void submitTailBlock() noexcept;
+
+    /*
+     Audio thread: checks that the tail block played from now on has been computed. Normally the
+     background thread finished it long ago. If not, the next tail block plays silent and its input
+     is dropped (the background thread may still read that buffer), and false is returned.
+     computeIfLate is for offline renders only: the calling thread finishes the tail itself.
+     */
+    bool prepareDueTailBlock (bool computeIfLate) noexcept;
+
+    ///Any thread: computes every tail block handed over so far. Returns false if another thread is already on it
+    bool processPendingTail() noexcept;
+
+    size_t getMemoryFootprintBytes() const noexcept;
+
+private:
+
+    void processMidBlock() noexcept;
+    void processTailBlock (int blockIndex) noexcept;
+
+    std::shared_ptr<const CabinetImpulse> _impulse;
+    int _numChannels = 0;
+    int _numMidPartitions = 0, _numTailPartitions = 0;
+
+    //Head FIR, the history is written twice so the dot product never wraps
+    AlignedBuffer<float> _headHistory;
+    int _headPos = 0;
+
+    //Mid partitions (audio thread)
+    juce::dsp::FFT _midFFT { CabinetImpulse::midFFTOrder };
+    AlignedBuffer<float> _midWindow, _midOutput, _midDelayLine, _midScratch;
+    int _midPos = 0, _midDelayPos = 0;
+
+    //Tail partitions, input and output are double buffered between the two threads
+    juce::dsp::FFT _tailFFT { CabinetImpulse::tailFFTOrder };
+    AlignedBuffer<float> _tailInput, _tailOutput;
+    AlignedBuffer<float> _tailWindow, _tailDelayLine, _tailScratch;
+    int _tailPos = 0, _tailDelayPos = 0;
+    int _tailBlockCount = 0;
+    bool _tailOutputValid = false, _tailInputValid = true;
+
+    //Block counts only ever grow, a reset moves _tailResetBlock to the block being filled
+    std::atomic<int> _tailSubmitted { 0 }, _tailCompleted { 0 }, _tailResetBlock { 0 };
+    std::atomic<bool> _tailBusy { false };
+    int _tailClearedBlock = 0;
+
+    //The block each input buffer was last filled for, a dropped block reads as silence
+    std::array<std::atomic<int>, 2> _tailFilled { { -1, -1 } };
+
+    JUCE_DECLARE_NON_COPYABLE (CabinetEngine)
+};
+
+//==============================================================================
+class CabinetConvolution;
+
+///One thread for the tails of every BuzzBox instance in the process
+class CabinetTailThread : private juce::Thread
+
+{
+public:
+
+    CabinetTailThread();
+    ~CabinetTailThread() override;
+
+    void addConvolution (CabinetConvolution* convolution);
+    void removeConvolution (CabinetConvolution* convolution);
+
+    ///Audio thread: a tail block is waiting. Only sets a flag the thread polls, signalling its event would lock
+    void wakeUp() noexcept { _pending.store (true, std::memory_order_release); }
+
+private:
+
+    void run() override;
+
+    //Well inside the time a tail block has, tailBlockSize samples even at 192 kHz
+    static constexpr int pollIntervalMs = 1;
+
+    std::atomic<bool> _pending { false };
+
+    juce::CriticalSection _lock;
+    juce::Array<CabinetConvolution*> _convolutions;
+};
+
+//==============================================================================
+class CabinetConvolution
+
+{
+public:
+
+    CabinetConvolution();
+    ~CabinetConvolution();
+
+    void prepare (const juce::dsp::ProcessSpec& spec);
+    void reset() noexcept;
+
+    ///Message thread: decoding and resampling happen on the loader thread
+    void loadImpulseResponse (const juce::File& file);
+
+    ///Message thread: back to no cabinet, the audio thread lets go of the engine at its next block
+    void clearImpulseResponse();
+    juce::File getImpulseResponseFile() const { return _loader.getFile(); }
+    juce::String getLastError() const { return _loader.getLastError(); }
+    bool isLoading() const { return _loader.isLoading(); }
+
+    //Switching on restarts from a clean state so no old tail comes back
+    void setEnabled (bool shouldBeEnabled) noexcept { _enabled.store (shouldBeEnabled); }
+    bool isEnabled() const noexcept { return _enabled.load(); }
+
+    ///Message thread, nothing after clearImpulseResponse() even if a build finishes behind it
+    double getTailLengthSeconds() const { return getImpulseResponseFile() == juce::File() ? 0.0 : _impulseSeconds.load(); }
+
+    ///Offline renders may compute a late tail block on the calling thread, real time never does
+    void setNonRealtime (bool isNonRealtime) noexcept { _nonRealtime.store (isNonRealtime, std::memory_order_relaxed); }
+
+    ///Tail blocks the background thread did not finish in time since the last prepare
+    int getNumTailOverruns() const noexcept { return _tailOverruns.load (std::memory_order_relaxed); }
+
+    ///State of the last engine built, the impulse itself is shared and not counted
+    size_t getMemoryFootprintBytes() const noexcept { return sizeof (*this) + _engineBytes.load(); }
+
+    template <typename ProcessContext>
+    void process (const ProcessContext& context) noexcept
+    {
+        using SampleType = typename ProcessContext::SampleType;
+
+        auto* engine = acquireEngine();
+
+        const bool enabled = _enabled.load (std::memory_order_relaxed);
+        const bool wasEnabled = std::exchange (_wasEnabled, enabled);
+
+        if (! enabled || engine == nullptr || context.isBypassed)
+            return;
+
+        if (! wasEnabled)
+            engine->reset();
+
+        auto& outputBlock = context.getOutputBlock();
+        const auto numChannels = juce::jmin ((int) outputBlock.getNumChannels(), (int) _channelPointers.size());
+        const auto numSamples  = (int) outputBlock.getNumSamples();
+
+        //Replacing contexts only, the engine convolves in place
+        for (int start = 0; start < numSamples; start += _maxBlockSize)
+        {
+            const auto count = juce::jmin (_maxBlockSize, numSamples - start);
+
+            //The engine works in float whatever the precision of the chain
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                if constexpr (std::is_same<SampleType, float>::value)
+                {
+                    _channelPointers[(size_t) channel] = outputBlock.getChannelPointer ((size_t) channel) + start;
+                }
+                else
+                {
+                    auto* samples = outputBlock.getChannelPointer ((size_t) channel) + start;
+                    auto* converted = _floatBuffer.getWritePointer (channel);
+
+                    for (int i = 0; i < count; ++i)
+                        converted[i] = static_cast<float> (samples[i]);
+
+                    _channelPointers[(size_t) channel] = converted;
+                }
+            }
+
+            for (int done = 0; done < count;)
+            {
+                done += engine->processSegment (_channelPointers.data(), numChannels, done, count - done);
+
+                if (engine->isTailBlockComplete())
+                    submitTailBlock (*engine);
+            }
+
+            if constexpr (! std::is_same<SampleType, float>::value)
+            {
+                for (int channel = 0; channel < numChannels; ++channel)
+                {
+                    auto* samples = outputBlock.getChannelPointer ((size_t) channel) + start;
+                    auto* converted = _floatBuffer.getReadPointer (channel);
+
+                    for (int i = 0; i < count; ++i)
+                        samples[i] = static_cast<SampleType> (converted[i]);
+                }
+            }
+        }
+    }
+
+private:
+
+    friend class CabinetTailThread;
+
+    //Audio thread: swaps in a newly built engine once the tail thread can not be holding the old one
+    CabinetEngine* acquireEngine() noexcept;
+
+    //Audio thread: hands the tail block over, flags it for the tail thread and counts a late one
+    void submitTailBlock (CabinetEngine& engine) noexcept;
+
+    //Tail thread
+    void processPendingTail() noexcept;
+
+    //Loader thread
+    std::unique_ptr<CabinetEngine> buildEngine (const juce::File& file, juce::String& errorMessage);
+
+    struct DecodedFile;
+    static std::shared_ptr<const DecodedFile> decodeFile (const juce::File& file, juce::String& errorMessage);
+    static std::shared_ptr<const CabinetImpulse> buildImpulse (const DecodedFile& decoded, double sampleRate);
+
+    juce::SharedResourcePointer<CabinetTailThread> _tailThread;
+    juce::SharedResourcePointer<SharedResourceCache> _sharedResources;
+    BackgroundLoader<CabinetEngine> _loader;
+
+    //The engine the tail thread may work on, handed over with a Dekker style check
+    std::atomic<CabinetEngine*> _tailEngine { nullptr };
+    std::atomic<bool> _tailThreadInside { false };
+
+    std::atomic<bool> _enabled { false };
+    bool _wasEnabled = false;
+
+    std::atomic<bool> _nonRealtime { false };
+    std::atomic<int> _tailOverruns { 0 };
+
+    std::atomic<double> _sampleRate { 0.0 };
+    std::atomic<int> _numChannels { 2 };
+    std::atomic<double> _impulseSeconds { 0.0 };
+    std::atomic<size_t> _engineBytes { 0 };
+    int _maxBlockSize = 0;
+
+    std::vector<float*> _channelPointers;
+    juce::AudioBuffer<float> _floatBuffer;
+
+    //Decoded file, shared by every instance that loaded it and kept so a sample rate change only resamples (loader thread only)
+    struct DecodedFile
+    {
+        juce::AudioBuffer<float> buffer;
+        double sampleRate = 0.0;
+
+        size_t getMemoryFootprintBytes() const noexcept
+        {
+            return sizeof (*this) + (size_t) buffer.getNumChannels() * (size_t) buffer.getNumSamples() * sizeof (float);
+        }
+    };
+
+    juce::String _decodedKey;
+    std::shared_ptr<const DecodedFile> _decoded;
+
+    //Longer files are cut, a cabinet rarely rings for more than a fraction of this
+    static constexpr double maxImpulseSeconds = 2.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CabinetConvolution)
+};
@@ -0,0 +1,186 @@
+/*
+  ==============================================================================
+
+    ChebyshevShaper.cpp
+    Created: 20 Oct 2026 3:04:51am
+    Author:  Alperen Kurbetci
+
+  ==============================================================================
+*/
+
+#include "ChebyshevShaper.h"
+
+HarmonicDesignThread::HarmonicDesignThread() : juce::Thread ("BuzzBox Harmonic Designer")
+{
+    startThread();
+}
+
+HarmonicDesignThread::~HarmonicDesignThread()
+{
+    stopThread (2000);
+}
+
+void HarmonicDesignThread::addClient (Client* client)
+{
+    const juce::ScopedLock sl (_lock);
+    _clients.addIfNotAlreadyThere (client);
+}
+
+void HarmonicDesignThread::removeClient (Client* client)
+{
+    const juce::ScopedLock sl (_lock);
+    _clients.removeFirstMatchingValue (client);
+}
+
+void HarmonicDesignThread::run()
+{
+    while (! threadShouldExit())
+    {
+        {
+            const juce::ScopedLock sl (_lock);
+
+            for (auto* client : _clients)
+                client->buildPendingDesign();
+        }
+
+        wait (pollIntervalMs);
+    }
+}
+
+//==============================================================================
+template <typename SampleType>
+
+ChebyshevShaper<SampleType>::ChebyshevShaper()
+{
+    //Every slot starts as the identity, whichever the reader ends up with
+    Design identity {};
+    identity[1] = SampleType (1);
+
+    _designs.fill (identity);
+
+    _designThread->addClient (this);
+}
+
+template <typename SampleType>
+
+ChebyshevShaper<SampleType>::~ChebyshevShaper()
+{
+    _designThread->removeClient (this);
+}
+
+template <typename SampleType>
+
+void ChebyshevShaper<SampleType>::setHarmonics (const Levels& levels) noexcept
+{
+    if (levels == _levels)
+        return;
+
+    _levels = levels;
+
+    for (size_t i = 0; i < levels.size(); ++i)
+        _requested[i].store (levels[i], std::memory_order_relaxed);
+
+    _requestPending.store (true, std::memory_order_release);
+}
+
+template <typename SampleType>
+
+void ChebyshevShaper<SampleType>::setNonRealtime (bool shouldBeNonRealtime)
+{
+    if (shouldBeNonRealtime == _nonRealtime)
+        return;
+
+    //Out of the thread's list first, there is only ever one thread building
+    if (shouldBeNonRealtime)
+        _designThread->removeClient (this);
+
+    _nonRealtime = shouldBeNonRealtime;
+
+    if (! shouldBeNonRealtime)
+        _designThread->addClient (this);
+}
+
+template <typename SampleType>
+
+void ChebyshevShaper<SampleType>::buildPendingDesign() noexcept
+{
+    if (! _requestPending.exchange (false, std::memory_order_acquire))
+        return;
+
+    Levels levels;
+
+    for (size_t i = 0; i < levels.size(); ++i)
+        levels[i] = _requested[i].load (std::memory_order_relaxed);
+
+    int order = 1;
+    _designs[(size_t) _back] = buildDesign (levels, order);
+
+    //Goes out with the design, the oversampling may follow it a block late
+    _order.store (order, std::memory_order_relaxed);
+    _back = _middle.exchange (_back | dirtyFlag, std::memory_order_acq_rel) & indexMask;
+}
+
+template <typename SampleType>
+
+typename ChebyshevShaper<SampleType>::Design ChebyshevShaper<SampleType>::buildDesign (const Levels& levels, int& order) noexcept
+{
+    //T_k in powers of x by T_k+1 = 2x T_k - T_k-1, summed with the levels in double
+    std::array<double, maxHarmonic + 1> previous {}, current {}, sum {};
+    previous[0] = 1.0;
+    current[1] = 1.0;
+    sum[1] = 1.0;
+    order = 1;
+
+    for (int k = 2; k <= maxHarmonic; ++k)
+    {
+        std::array<double, maxHarmonic + 1> next {};
+
+        for (int power = 0; power < maxHarmonic; ++power)
+            next[(size_t) power + 1] = 2.0 * current[(size_t) power];
+
+        for (int power = 0; power <= maxHarmonic; ++power)
+            next[(size_t) power] -= previous[(size_t) power];
+
+        previous = current;
+        current = next;
+
+        const auto level = (double) levels[(size_t) (k - 2)];
+
+        if (level == 0.0)
+            continue;
+
+        order = k;
+
+        for (int power = 0; power <= maxHarmonic; ++power)
+            sum[(size_t) power] += level * current[(size_t) power];
+    }
+
+    //The even harmonics leave an offset at rest, silence has to stay silent
+    sum[0] = 0.0;
+
+    //Peak over the clamped range, a coarse grid is close enough since p has at most maxHarmonic - 1 turning points
+    auto peak = 0.0;
+
+    for (int i = 0; i <= 256; ++i)
+    {
+        const auto x = -1.0 + i / 128.0;
+        auto y = 0.0;
+
+        for (int power = maxHarmonic; power >= 0; --power)
+            y = y * x + sum[(size_t) power];
+
+        peak = juce::jmax (peak, std::abs (y));
+    }
+
+    const auto scale = peak > 1.0 ? 1.0 / peak : 1.0;
+
+    Design design {};
+
+    for (int power = 0; power <= maxHarmonic; ++power)
+        design[(size_t) power] = static_cast<SampleType> (sum[(size_t) power] * scale);
+
+    return design;
+}
+
+template class ChebyshevShaper<float>;
+template class ChebyshevShaper<double>;
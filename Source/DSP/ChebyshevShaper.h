@@ -0,0 +1,178 @@
+/*
+  ==============================================================================
+
+    ChebyshevShaper.h
+    Created: 20 Oct 2026 3:04:51am
+    Author:  Alperen Kurbetci
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+///One thread building the harmonic designs of every shaper in the process
+class HarmonicDesignThread : private juce::Thread
+
+{
+public:
+
+    ///A shaper with a design to build now and then
+    struct Client
+    {
+        virtual ~Client() = default;
+        virtual void buildPendingDesign() noexcept = 0;
+    };
+
+    HarmonicDesignThread();
+    ~HarmonicDesignThread() override;
+
+    ///Waits for the current pass, so the client is never touched after removeClient() returns
+    void addClient (Client* client);
+    void removeClient (Client* client);
+
+private:
+
+    void run() override;
+
+    //A parameter move is heard this much later at most, nothing on the audio thread signals
+    static constexpr int pollIntervalMs = 5;
+
+    juce::CriticalSection _lock;
+    juce::Array<Client*> _clients;
+};
+
+/*
+ Harmonic designer: the user sets the level of harmonics 2 - maxHarmonic, the shaper is the
+ polynomial that gives exactly those harmonics for a full scale sine,
+
+     p (x) = T1 (x) + sum h_k T_k (x),   T_k (cos w) = cos (k w)
+
+ converted to powers of x, moved so silence stays silent and scaled down if it would peak
+ above full scale. setHarmonics() only stores the levels, so the audio thread may call it.
+ The design is built on the shared HarmonicDesignThread and handed back through a lock free
+ triple buffer; a non real time shaper builds it on the calling thread at the next block
+ instead, so renders are the same every time. process() only evaluates the finished
+ polynomial (Estrin's scheme, a branch free loop the compiler vectorises).
+
+ A polynomial of order N turns a signal limited to the band B into one limited to N B. At the
+ rate R fs its images fold back down to R fs - N B, which stays above the input band B (where
+ the decimation filters take it away) for R >= (N + 1) / 2. getOversamplingOrder() gives the
+ smallest power of two that does it, so the oversampling is only as high as the design needs.
+ The band limit holds while the driven signal stays within -1 - 1, beyond that it is clamped.
+ */
+template <typename SampleType>
+
+class ChebyshevShaper : private HarmonicDesignThread::Client
+
+{
+public:
+
+    static constexpr int maxHarmonic = 8;
+    static constexpr int numHarmonics = maxHarmonic - 1;
+
+    using Levels = std::array<SampleType, numHarmonics>;
+
+    ChebyshevShaper();
+    ~ChebyshevShaper() override;
+
+    ///One writer at a time, any thread (does not build, allocate or lock): levels of harmonics 2 - maxHarmonic relative to the fundamental, 0 - 1
+    void setHarmonics (const Levels& levels) noexcept;
+
+    ///Message thread: a non real time shaper builds its designs in acquireDesign() instead of on the design thread
+    void setNonRealtime (bool shouldBeNonRealtime);
+
+    ///Highest harmonic of the latest design, 1 when it only passes the fundamental
+    int getOrder() const noexcept { return _order.load (std::memory_order_relaxed); }
+
+    ///log2 of the smallest oversampling factor that keeps the images of an order N polynomial out of the input band
+    static size_t getOversamplingOrder (int polynomialOrder) noexcept
+    {
+        size_t order = 0;
+
+        while (((size_t) 2 << order) < (size_t) (polynomialOrder + 1))
+            ++order;
+
+        return order;
+    }
+
+    ///Audio thread, once per block: picks up the latest design if there is one
+    void acquireDesign() noexcept
+    {
+        if (_nonRealtime)
+            buildPendingDesign();
+
+        if ((_middle.load (std::memory_order_acquire) & dirtyFlag) != 0)
+            _front = _middle.exchange (_front, std::memory_order_acq_rel) & indexMask;
+    }
+
+    ///The driven signal in place
+    void process (SampleType* samples, int numSamples) const noexcept
+    {
+        //Loop invariant copies, so the coefficients stay in registers
+        const auto& design = _designs[(size_t) _front];
+        const auto c0 = design[0], c1 = design[1], c2 = design[2], c3 = design[3], c4 = design[4];
+        const auto c5 = design[5], c6 = design[6], c7 = design[7], c8 = design[8];
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto x = juce::jlimit (SampleType (-1), SampleType (1), samples[i]);
+            const auto x2 = x * x;
+            const auto x4 = x2 * x2;
+
+            //Estrin: four independent pairs, then two levels of combining, instead of one long Horner chain
+            const auto p01 = c0 + c1 * x;
+            const auto p23 = c2 + c3 * x;
+            const auto p45 = c4 + c5 * x;
+            const auto p67 = c6 + c7 * x;
+
+            const auto p03 = p01 + p23 * x2;
+            const auto p47 = p45 + p67 * x2;
+
+            samples[i] = p03 + (p47 + c8 * x4) * x4;
+        }
+    }
+
+    ///One driven sample, for callers that run several stages per sample
+    SampleType processSample (SampleType sample) const noexcept
+    {
+        const auto& c = _designs[(size_t) _front];
+        const auto x = juce::jlimit (SampleType (-1), SampleType (1), sample);
+        const auto x2 = x * x;
+        const auto x4 = x2 * x2;
+
+        return (c[0] + c[1] * x) + (c[2] + c[3] * x) * x2 + ((c[4] + c[5] * x) + (c[6] + c[7] * x) * x2 + c[8] * x4) * x4;
+    }
+
+private:
+
+    //Powers 0 - maxHarmonic of x
+    using Design = std::array<SampleType, maxHarmonic + 1>;
+
+    static Design buildDesign (const Levels& levels, int& order) noexcept;
+
+    //Design thread, or the audio thread when non real time: builds the latest levels if they have changed
+    void buildPendingDesign() noexcept override;
+
+    juce::SharedResourcePointer<HarmonicDesignThread> _designThread;
+    bool _nonRealtime = false;
+
+    //Triple buffer: the writer fills its back slot and swaps it into the middle, the reader swaps the middle into its front
+    static constexpr int indexMask = 3;
+    static constexpr int dirtyFlag = 4;
+
+    std::array<Design, 3> _designs;
+    std::atomic<int> _middle { 1 };
+    int _back = 2;
+    int _front = 0;
+    std::atomic<int> _order { 1 };
+
+  //setHarmonics() side only, every parameter change calls it and most leave these alone
+    Levels _levels {};
+
+  //Levels waiting for a design, each one atomic: a torn set is followed by another build
+    std::array<std::atomic<SampleType>, numHarmonics> _requested {};
+    std::atomic<bool> _requestPending { false };
+
+    JUCE_DECLARE_NON_COPYABLE (ChebyshevShaper)
+};
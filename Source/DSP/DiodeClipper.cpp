@@ -0,0 +1,38 @@
+/*
+  ==============================================================================
+
+    DiodeClipper.cpp
+    Created: 19 Oct 2026 4:07:52pm
+    Author:  Alperen Kurbetci
+
+  ==============================================================================
+*/
+
+#include "DiodeClipper.h"
+
+template <typename SampleType>
+
+DiodeClipper<SampleType>::DiodeClipper()
+{
+
+}
+
+template <typename SampleType>
+
+void DiodeClipper<SampleType>::prepare (double sampleRate, int numChannels)
+{
+    _halfT = static_cast<SampleType> (0.5 / sampleRate);
+
+    _numChannels = (size_t) numChannels;
+    _state.allocate (2 * _numChannels, true);
+}
+
+template <typename SampleType>
+
+void DiodeClipper<SampleType>::reset()
+{
+    _state.clear();
+}
+
+template class DiodeClipper<float>;
+template class DiodeClipper<double>;
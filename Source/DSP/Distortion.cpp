@@ -1,108 +1,812 @@
-/*
-  ==============================================================================
-
-    Distortion.cpp
-    Created: 12 Mar 2023 12:36:54pm
-    Author:  Alperen Kurbetci
-
-  ==============================================================================
-*/
-
-#include "Distortion.h"
-
-//JUCE example dsp folders have this line for the SampleType. It must be used just above every time typename is called
-template <typename SampleType>
-
-Distortion<SampleType>::Distortion()
-{
-    
-}
-
-template <typename SampleType>
-
-//Setting up the specs
-void Distortion<SampleType>::prepare(juce::dsp::ProcessSpec &spec)
-{
-   
-    _sampleRate = spec.sampleRate;
-    
-    dcFilter.prepare(spec);
-    dcFilter.setCutoffFrequency(10.0);
-    dcFilter.setType(juce::dsp::LinkwitzRileyFilter<float>::Type::highpass);
-    
-    
-    reset();
-    
-}
-
-template <typename SampleType>
-
-//Reaching to the parameters from the ./Parameters/Globals.h
-void Distortion<SampleType>::reset()
-{
-    if(_sampleRate <= 0) return;
-    
-    _input.reset(_sampleRate, 0.02);
-    _input.setTargetValue(0.0);
-    
-    _output.reset(_sampleRate, 0.02);
-    _output.setTargetValue(1.0);
-    
-    _mix.reset(_sampleRate, 0.02);
-    _mix.setTargetValue(0.0);
-}
-
-template <typename SampleType>
-
-//Getting the values from the user inputs
-void Distortion<SampleType>::setDrive(SampleType newDrive)
-{
-    _input.setTargetValue(newDrive);
-}
-
-template <typename SampleType>
-void Distortion<SampleType>::setMix(SampleType newMix)
-{
-    
-    _mix.setTargetValue(newMix);
-}
-
-template <typename SampleType>
-void Distortion<SampleType>::setOutput(SampleType nexOutput)
-{
-    _output.setTargetValue(nexOutput);
-}
-
-//Switching betwen choices
-template <typename SampleType>
-void Distortion<SampleType>::setDistortionModel(DistortionModel newModel)
-{
-    switch(newModel)
-    {
-        case DistortionModel::cHard:
-    {
-        _model = newModel;
-        break;
-    }
-    
-    
-        case DistortionModel::cSoft:
-    {
-        _model = newModel;
-        break;
-    }
-    
-    
-        case DistortionModel::cSaturation:
-    {
-        _model = newModel;
-        break;
-    }
-
-    }
-     
-}
-
-//Setting up the types of variables that the typename template can have
-template class Distortion<float>;
-template class Distortion<double>;
+/*
+  ==============================================================================
+
+    Distortion.cpp
+    Created: 12 Mar 2023 12:36:54pm
+    Author:  Alperen Kurbetci
+
+  ==============================================================================
+*/
+
+#include "Distortion.h"
+
+//JUCE example dsp folders have this line for the SampleType. It must be used just above every time typename is called
+template <typename SampleType>
+
+Distortion<SampleType>::Distortion()
+{
+    _triode.setCurve(BiasedShaper<SampleType>::Curve::cTriode);
+    
+    for (auto& stage : _stages)
+        stage.triode.setCurve(BiasedShaper<SampleType>::Curve::cTriode);
+}
+
+template <typename SampleType>
+
+//Setting up the specs
+void Distortion<SampleType>::prepare(juce::dsp::ProcessSpec &spec)
+{
+   
+    _sampleRate = spec.sampleRate;
+    _maxBlockSize = spec.maximumBlockSize;
+    _numChannels = spec.numChannels;
+    
+    _neuralState.allocate((size_t) maxStages * _numChannels * NeuralNetworkBase::maxStateSize, true);
+    _stageFilters.allocate((size_t) (maxStages - 1) * _numChannels * stageFilterSize, true);
+    _neuralBuffer.allocate(_maxBlockSize, true);
+    _scratch.allocate(scratchSize * _maxBlockSize, true);
+    
+    //Sized for the shortest control interval the matrix allows
+    _maxControlValues = (size_t) EnvelopeFollower::getNumValues((int) _maxBlockSize, ModulationMatrix::minControlInterval);
+    _control.allocate(controlSize * _maxControlValues, true);
+    
+    _diodeClipper.prepare(spec.sampleRate, (int) spec.numChannels);
+    _tape.prepare(spec.sampleRate, (int) spec.numChannels);
+    
+    for (auto& stage : _stages)
+    {
+        stage.diodeClipper.prepare(spec.sampleRate, (int) spec.numChannels);
+        stage.tape.prepare(spec.sampleRate, (int) spec.numChannels);
+        stage.folder.prepare((int) spec.numChannels);
+        stage.triode.prepare((int) spec.numChannels);
+    }
+    
+    _folder.prepare((int) spec.numChannels);
+    _triode.prepare((int) spec.numChannels);
+    
+    _dcState.allocate(2 * _numChannels, true);
+    _dcPole = static_cast<SampleType> (std::exp(-juce::MathConstants<double>::twoPi * (double) dcCutoff / spec.sampleRate));
+    
+    //One table per precision and rate for the whole process
+    const auto tableKey = juce::String ("Distortion auto gain/") + (std::is_same_v<SampleType, float> ? "float/" : "double/")
+                        + juce::String (spec.sampleRate);
+    _autoGainTable = _sharedResources->getOrBuild<AutoGainTable> (tableKey, [this] { return buildAutoGainTable(); });
+    
+    reset();
+    
+}
+
+template <typename SampleType>
+
+//Reaching to the parameters from the ./Parameters/Globals.h
+void Distortion<SampleType>::reset()
+{
+    if(_sampleRate <= 0) return;
+    
+    //The smoothers jump to their targets, the settings themselves are kept
+    for (auto& lane : _lanes)
+    {
+        lane.input.reset(_sampleRate, 0.02);
+        lane.mix.reset(_sampleRate, 0.02);
+    }
+    
+    _output.reset(_sampleRate, 0.02);
+    
+    _blend.reset(_sampleRate, 0.02);
+    
+    _diodeClipper.reset();
+    _tape.reset();
+    
+    for (auto& stage : _stages)
+    {
+        stage.drive.reset(_sampleRate, 0.02);
+        stage.diodeClipper.reset();
+        stage.tape.reset();
+        stage.folder.reset();
+        stage.triode.reset();
+    }
+    
+    _stageFilters.clear();
+    _folder.reset();
+    _triode.reset();
+    _dcState.clear();
+    _neuralState.clear();
+    
+    _autoGainDb = SampleType (0);
+    _tableGain = SampleType (1);
+    _residualDb = SampleType (0);
+    _inputPower = 0.0;
+    _outputPower = 0.0;
+    _output.setCurrentAndTargetValue(juce::Decibels::decibelsToGain(_userOutput));
+    
+    _modulation = {};
+    _modulated = false;
+}
+
+template <typename SampleType>
+
+//Getting the values from the user inputs
+void Distortion<SampleType>::setDrive(SampleType newDrive, size_t lane)
+{
+    _lanes[lane].input.setTargetValue(newDrive);
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::setMix(SampleType newMix, size_t lane)
+{
+    
+    _lanes[lane].mix.setTargetValue(newMix);
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::setOutput(SampleType nexOutput)
+{
+    _userOutput = nexOutput;
+    _output.setTargetValue(juce::Decibels::decibelsToGain(_userOutput + (_autoGain ? _autoGainDb : SampleType (0))));
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::setAutoGain(bool shouldCompensate)
+{
+    if (shouldCompensate == _autoGain)
+        return;
+    
+    _autoGain = shouldCompensate;
+    
+    //Starts over from the table alone, then the tracker settles again
+    _autoGainDb = SampleType (0);
+    _residualDb = SampleType (0);
+    _inputPower = 0.0;
+    _outputPower = 0.0;
+    
+    _output.setTargetValue(juce::Decibels::decibelsToGain(_userOutput));
+}
+
+//Switching betwen choices
+template <typename SampleType>
+void Distortion<SampleType>::setDistortionModel(DistortionModel newModel, size_t lane)
+{
+    auto& model = _lanes[lane].model;
+    
+    switch(newModel)
+    {
+        case DistortionModel::cHard:
+    {
+        model = newModel;
+        break;
+    }
+    
+    
+        case DistortionModel::cSoft:
+    {
+        model = newModel;
+        break;
+    }
+    
+    
+        case DistortionModel::cSaturation:
+    {
+        model = newModel;
+        break;
+    }
+    
+    
+        case DistortionModel::cNeural:
+    {
+        model = newModel;
+        break;
+    }
+    
+    
+        case DistortionModel::cDiode:
+    {
+        model = newModel;
+        break;
+    }
+    
+    
+        case DistortionModel::cTape:
+    {
+        model = newModel;
+        break;
+    }
+    
+    
+        case DistortionModel::cHarmonics:
+    {
+        model = newModel;
+        break;
+    }
+    
+    
+        case DistortionModel::cFold:
+    {
+        model = newModel;
+        break;
+    }
+    
+    
+        case DistortionModel::cTriode:
+    {
+        model = newModel;
+        break;
+    }
+
+    }
+     
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::setTapeBias(SampleType newBias) noexcept
+{
+    _tape.setBias(newBias);
+    
+    for (auto& stage : _stages)
+        stage.tape.setBias(newBias);
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::setTapeSaturation(SampleType newSaturation) noexcept
+{
+    _tape.setSaturation(newSaturation);
+    
+    for (auto& stage : _stages)
+        stage.tape.setSaturation(newSaturation);
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::setTapeSolver(typename TapeHysteresis<SampleType>::Solver newSolver) noexcept
+{
+    _tape.setSolver(newSolver);
+    
+    for (auto& stage : _stages)
+        stage.tape.setSolver(newSolver);
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::setFoldShape(typename BiasedShaper<SampleType>::Curve newShape) noexcept
+{
+    _folder.setCurve(newShape);
+    
+    for (auto& stage : _stages)
+        stage.folder.setCurve(newShape);
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::setShaperBias(SampleType newBias) noexcept
+{
+    _folder.setBias(newBias);
+    _triode.setBias(newBias);
+    
+    for (auto& stage : _stages)
+    {
+        stage.folder.setBias(newBias);
+        stage.triode.setBias(newBias);
+    }
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::setNumStages(int newNumStages) noexcept
+{
+    _requestedStages = juce::jlimit(1, maxStages, newNumStages);
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::updateNumStages() noexcept
+{
+    const auto newNumStages = _requestedStages;
+    
+    //A stage coming in starts from silence, not from whatever it held when it was dropped
+    for (auto stage = (size_t) _numStages - 1; stage < (size_t) newNumStages - 1; ++stage)
+    {
+        _stages[stage].drive.setCurrentAndTargetValue(_stages[stage].drive.getTargetValue());
+        _stages[stage].diodeClipper.reset();
+        _stages[stage].tape.reset();
+        _stages[stage].folder.reset();
+        _stages[stage].triode.reset();
+        
+        for (size_t channel = 0; channel < _numChannels; ++channel)
+            std::fill_n(getStageFilter(stage, (int) channel), stageFilterSize, SampleType (0));
+        
+        if (_numChannels > 0)
+            std::fill_n(_neuralState.get() + (stage + 1) * _numChannels * NeuralNetworkBase::maxStateSize,
+                        _numChannels * NeuralNetworkBase::maxStateSize, 0.0f);
+    }
+    
+    _numStages = newNumStages;
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::setStageModel(size_t stage, DistortionModel newModel) noexcept
+{
+    _stages[stage].model = newModel;
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::setStageDrive(size_t stage, SampleType newDrive) noexcept
+{
+    _stages[stage].drive.setTargetValue(newDrive);
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::setStageTone(size_t stage, SampleType newCutoff) noexcept
+{
+    _stages[stage].tone = newCutoff;
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::fillStageRamps(size_t count) noexcept
+{
+    const auto step = SampleType (1) / (SampleType) count;
+    const auto twoPiOverRate = juce::MathConstants<SampleType>::twoPi / (SampleType) _sampleRate;
+    
+    for (size_t index = 0; index + 1 < (size_t) _numStages; ++index)
+    {
+        auto& stage = _stages[index];
+        auto& ramp = _stageRamps[index];
+        
+        const auto startDrive = stage.drive.getCurrentValue();
+        stage.drive.skip((int) count);
+        const auto endDrive = stage.drive.getCurrentValue();
+        
+        ramp.preGain  = getPreGain(stage.model, startDrive);
+        ramp.preStep  = (getPreGain(stage.model, endDrive) - ramp.preGain) * step;
+        ramp.postGain = getPostGain(stage.model, startDrive);
+        ramp.postStep = (getPostGain(stage.model, endDrive) - ramp.postGain) * step;
+        
+        //One pole each, the tone is kept below the Nyquist of the rate it runs at
+        const auto tone = juce::jlimit(SampleType (20), SampleType (0.45) * (SampleType) _sampleRate, stage.tone);
+        ramp.highPass = std::exp(-couplingCutoff * twoPiOverRate);
+        ramp.lowPass  = SampleType (1) - std::exp(-tone * twoPiOverRate);
+    }
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::setStereoMode(StereoMode newMode)
+{
+    _stereoMode = newMode;
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::setSafetyClip(bool shouldClip) noexcept
+{
+    _safetyClip = shouldClip;
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::setBlendModel(DistortionModel newModel)
+{
+    _blendModel = newModel;
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::setBlend(SampleType newBlend)
+{
+    _blend.setTargetValue(newBlend);
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::setModulation(const ModulationMatrix::Block& modulation) noexcept
+{
+    _modulation = modulation;
+}
+
+template <typename SampleType>
+bool Distortion<SampleType>::usesModel(DistortionModel model) const noexcept
+{
+    //Lane 1 is silent when linked, the blend model counts whatever its amount since modulation can open it
+    if (_lanes[0].model == model || _blendModel == model)
+        return true;
+    
+    for (size_t stage = 0; stage + 1 < (size_t) _numStages; ++stage)
+        if (_stages[stage].model == model)
+            return true;
+    
+    return _stereoMode != StereoMode::cLinked && _lanes[1].model == model;
+}
+
+template <typename SampleType>
+size_t Distortion<SampleType>::getOversamplingOrder(size_t defaultOrder, bool blendModulated) const noexcept
+{
+    size_t order = 0;
+    
+    //Harmonic stages in a row multiply their orders, any other model in the chain asks for defaultOrder
+    const auto add = [&] (DistortionModel model)
+    {
+        auto polynomialOrder = 1;
+        auto polynomial = true;
+        
+        const auto addStage = [&] (DistortionModel stageModel)
+        {
+            if (stageModel == DistortionModel::cHarmonics)
+                polynomialOrder = juce::jmin(polynomialOrder * _harmonics.getOrder(), 1 << 16);
+            else
+                polynomial = false;
+        };
+        
+        addStage(model);
+        
+        for (size_t stage = 0; stage + 1 < (size_t) _numStages; ++stage)
+            addStage(_stages[stage].model);
+        
+        const auto needed = ChebyshevShaper<SampleType>::getOversamplingOrder(polynomialOrder);
+        order = juce::jmax(order, polynomial ? needed : juce::jmax(needed, defaultOrder));
+    };
+    
+    add(_lanes[0].model);
+    
+    if (_stereoMode != StereoMode::cLinked)
+        add(_lanes[1].model);
+    
+    if (blendModulated || _blend.isSmoothing() || _blend.getTargetValue() > SampleType (0))
+        add(_blendModel);
+    
+    return order;
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::setNeuralNetwork(const NeuralNetworkBase* newNetwork) noexcept
+{
+    //A different capture starts from silence, the old hidden state means nothing to it
+    if (newNetwork != _network)
+    {
+        _network = newNetwork;
+        _neuralState.clear();
+    }
+}
+
+template <typename SampleType>
+size_t Distortion<SampleType>::getMemoryFootprintBytes() const noexcept
+{
+    auto bytes = sizeof (*this) + _neuralState.getSizeInBytes() + _neuralBuffer.getSizeInBytes()
+         + _scratch.getSizeInBytes() + _control.getSizeInBytes() + _diodeClipper.getMemoryFootprintBytes()
+         + _tape.getMemoryFootprintBytes() + _stageFilters.getSizeInBytes() + _dcState.getSizeInBytes()
+         + _folder.getMemoryFootprintBytes() + _triode.getMemoryFootprintBytes();
+    
+    for (const auto& stage : _stages)
+        bytes += stage.diodeClipper.getMemoryFootprintBytes() + stage.tape.getMemoryFootprintBytes()
+               + stage.folder.getMemoryFootprintBytes() + stage.triode.getMemoryFootprintBytes();
+    
+    return bytes;
+}
+
+template <typename SampleType>
+SampleType Distortion<SampleType>::getPreGain(DistortionModel model, SampleType drive) noexcept
+{
+    //The saturation maps the 0 - 24 dB drive onto 0 - 6 dB
+    if (model == DistortionModel::cSaturation)
+        return juce::Decibels::decibelsToGain(drive * SampleType (0.25));
+    
+    return juce::Decibels::decibelsToGain(drive);
+}
+
+template <typename SampleType>
+SampleType Distortion<SampleType>::getPostGain(DistortionModel model, SampleType drive) noexcept
+{
+    switch(model)
+    {
+        case DistortionModel::cSoft:
+            return piDi * SampleType (2) * juce::Decibels::decibelsToGain(drive * SampleType (-0.25));
+            
+        case DistortionModel::cSaturation:
+            return SampleType (1.15) * juce::Decibels::decibelsToGain(drive * SampleType (-0.05));
+            
+        case DistortionModel::cHard:
+        case DistortionModel::cNeural:
+        case DistortionModel::cDiode:
+        case DistortionModel::cTape:
+        case DistortionModel::cHarmonics:
+        case DistortionModel::cFold:
+        case DistortionModel::cTriode:
+            return SampleType (1);
+    }
+    
+    return SampleType (1);
+}
+
+template <typename SampleType>
+bool Distortion<SampleType>::fillDriveGains(Lane& lane, LaneRamps& ramp, size_t count) noexcept
+{
+    const auto ramping = lane.input.isSmoothing();
+    
+    //The blend gains are only needed while the second model runs
+    for (size_t i = 0; i < (ramping ? count : 1); ++i)
+    {
+        const auto drive = ramping ? lane.input.getNextValue() : lane.input.getTargetValue();
+        ramp.preGains[i]  = getPreGain(lane.model, drive);
+        ramp.postGains[i] = getPostGain(lane.model, drive);
+        
+        if (ramp.blending)
+        {
+            ramp.blendPreGains[i]  = getPreGain(_blendModel, drive);
+            ramp.blendPostGains[i] = getPostGain(_blendModel, drive);
+        }
+    }
+    
+    return ramping;
+}
+
+template <typename SampleType>
+bool Distortion<SampleType>::fillRamp(juce::SmoothedValue<SampleType>& smoother, SampleType* values, size_t count) noexcept
+{
+    if (! smoother.isSmoothing())
+    {
+        values[0] = smoother.getTargetValue();
+        return false;
+    }
+    
+    for (size_t i = 0; i < count; ++i)
+        values[i] = smoother.getNextValue();
+    
+    return true;
+}
+
+template <typename SampleType>
+bool Distortion<SampleType>::fillOutputGains(SampleType* outputGains, size_t count) noexcept
+{
+    //Already a gain, one multiply per sample while it ramps
+    if (! _output.isSmoothing())
+    {
+        outputGains[0] = _output.getTargetValue();
+        return false;
+    }
+    
+    for (size_t i = 0; i < count; ++i)
+        outputGains[i] = _output.getNextValue();
+    
+    return true;
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::prepareModulation(size_t numSamples, size_t activeLanes) noexcept
+{
+    const auto interval = (size_t) _modulation.controlInterval;
+    const auto numValues = (size_t) EnvelopeFollower::getNumValues((int) numSamples, (int) interval);
+    
+    _controlInterval = interval;
+    _modulatedSamples = numSamples;
+    
+    //Destinations nothing modulates read as zero
+    auto getOffset = [this] (ModulationMatrix::Destination destination, size_t k)
+    {
+        const auto* offsets = _modulation.offsets[(int) destination];
+        return offsets != nullptr ? static_cast<SampleType> (offsets[k]) : SampleType (0);
+    };
+    
+    for (size_t i = 0; i < activeLanes; ++i)
+    {
+        auto& lane = _lanes[i];
+        auto* preGains       = getControl(i * scratchPerLane + scratchPreGain);
+        auto* postGains      = getControl(i * scratchPerLane + scratchPostGain);
+        auto* mixValues      = getControl(i * scratchPerLane + scratchMix);
+        auto* blendPreGains  = getControl(i * scratchPerLane + scratchBlendPreGain);
+        auto* blendPostGains = getControl(i * scratchPerLane + scratchBlendPostGain);
+        size_t position = 0;
+        
+        //Point k sits at sample k * interval, the smoothers are moved there before they are read
+        for (size_t k = 0; k < numValues; ++k)
+        {
+            const auto next = juce::jmin(k * interval, numSamples);
+            lane.input.skip((int) (next - position));
+            lane.mix.skip((int) (next - position));
+            position = next;
+            
+            const auto drive = juce::jlimit(minDriveDb, maxDriveDb, lane.input.getCurrentValue() + getOffset(ModulationMatrix::Destination::cDrive, k));
+            
+            preGains[k]       = getPreGain(lane.model, drive);
+            postGains[k]      = getPostGain(lane.model, drive);
+            blendPreGains[k]  = getPreGain(_blendModel, drive);
+            blendPostGains[k] = getPostGain(_blendModel, drive);
+            mixValues[k] = juce::jlimit(SampleType (0), SampleType (1), lane.mix.getCurrentValue() + getOffset(ModulationMatrix::Destination::cMix, k));
+        }
+    }
+    
+    //Output and blend are shared by the lanes, the output offset is in dB
+    auto* outputGains = getControl(scratchOutput);
+    auto* blendValues = getControl(scratchBlend);
+    size_t position = 0;
+    
+    for (size_t k = 0; k < numValues; ++k)
+    {
+        const auto next = juce::jmin(k * interval, numSamples);
+        _output.skip((int) (next - position));
+        _blend.skip((int) (next - position));
+        position = next;
+        
+        //The auto gain may already sit past the range, the modulation only ever moves it back inside
+        const auto output = juce::Decibels::gainToDecibels(_output.getCurrentValue());
+        const auto outputDb = juce::jlimit(juce::jmin(minOutputDb, output), juce::jmax(maxOutputDb, output),
+                                           output + getOffset(ModulationMatrix::Destination::cOutput, k));
+        
+        outputGains[k] = juce::Decibels::decibelsToGain(outputDb);
+        blendValues[k] = juce::jlimit(SampleType (0), SampleType (1), _blend.getCurrentValue() + getOffset(ModulationMatrix::Destination::cBlend, k));
+    }
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::fillModulatedRamps(size_t lane, LaneRamps& ramp, size_t start, size_t count) noexcept
+{
+    SampleType* ramps[] = { ramp.preGains, ramp.postGains, ramp.mixValues, ramp.blendPreGains, ramp.blendPostGains };
+    
+    for (size_t index = 0; index < scratchPerLane; ++index)
+        fillModulatedRamp(lane * scratchPerLane + index, ramps[index], start, count);
+    
+    ramp.driveRamping = true;
+    ramp.mixRamping = true;
+}
+
+template <typename SampleType>
+bool Distortion<SampleType>::fillModulatedRamp(size_t index, SampleType* values, size_t start, size_t count) noexcept
+{
+    const auto* control = getControl(index);
+    
+    //Frame by frame, sample i gets the value at i + 1 like a smoother's getNextValue()
+    for (auto sample = start; sample < start + count;)
+    {
+        const auto frame = sample / _controlInterval;
+        const auto begin = frame * _controlInterval;
+        const auto end = juce::jmin(begin + _controlInterval, _modulatedSamples);
+        const auto last = juce::jmin(end, start + count);
+        const auto slope = (control[frame + 1] - control[frame]) / SampleType (end - begin);
+        
+        for (auto i = sample; i < last; ++i)
+            values[i - start] = control[frame] + slope * SampleType (i + 1 - begin);
+        
+        sample = last;
+    }
+    
+    return true;
+}
+
+template <typename SampleType>
+std::shared_ptr<const typename Distortion<SampleType>::AutoGainTable> Distortion<SampleType>::buildAutoGainTable()
+{
+    auto table = std::make_shared<AutoGainTable>();
+    
+    //One period of a 200 Hz sine at -12 dBFS, run twice so the diode and the tape have settled on the second pass
+    constexpr double referenceLevel = 0.25;
+    const auto period = juce::jmax(16, juce::roundToInt(_sampleRate / 200.0));
+    
+    std::vector<SampleType> input ((size_t) period);
+    std::vector<SampleType> wet ((size_t) period);
+    
+    for (int i = 0; i < period; ++i)
+        input[(size_t) i] = static_cast<SampleType> (referenceLevel * std::sin(juce::MathConstants<double>::twoPi * i / period));
+    
+    const auto inputRms = std::sqrt(getEnergy(input.data(), period) / period);
+    
+    DiodeClipper<SampleType> diode;
+    diode.prepare(_sampleRate, 1);
+    
+    //The tape at its default bias and saturation, the folder and triode at theirs, the tracker covers the other settings
+    TapeHysteresis<SampleType> tape;
+    tape.prepare(_sampleRate, 1);
+    
+    BiasedShaper<SampleType> folder, triode;
+    folder.prepare(1);
+    triode.prepare(1);
+    triode.setCurve(BiasedShaper<SampleType>::Curve::cTriode);
+    
+    for (int model = 0; model < numModels; ++model)
+    {
+        const auto modelType = static_cast<DistortionModel> (model);
+        
+        for (int step = 0; step < autoGainSteps; ++step)
+        {
+            const auto drive = autoGainStepDb * SampleType (step);
+            auto& gain = table->gains[(size_t) model][(size_t) step];
+            
+            //A capture or a harmonic design is unknown until it plays, the tracker takes care of it
+            if (modelType == DistortionModel::cNeural || modelType == DistortionModel::cHarmonics)
+            {
+                gain = SampleType (1);
+                continue;
+            }
+            
+            diode.reset();
+            tape.reset();
+            folder.reset();
+            triode.reset();
+            
+            for (int pass = 0; pass < 2; ++pass)
+            {
+                juce::FloatVectorOperations::multiply (wet.data(), input.data(), getPreGain(modelType, drive), period);
+                
+                switch(modelType)
+                {
+                    case DistortionModel::cHard:       processHardClip(wet.data(), period); break;
+                    case DistortionModel::cSoft:       processSoftClip(wet.data(), period); break;
+                    case DistortionModel::cSaturation: processSaturation(wet.data(), period, 0); break;
+                    case DistortionModel::cNeural:     break;
+                    case DistortionModel::cHarmonics:  break;
+                    case DistortionModel::cDiode:
+                        for (auto& sample : wet)
+                            sample = diode.processSample(sample, 0);
+                        break;
+                    case DistortionModel::cTape:       tape.process(wet.data(), period, 0); break;
+                    case DistortionModel::cFold:       folder.process(wet.data(), period, 0); break;
+                    case DistortionModel::cTriode:     triode.process(wet.data(), period, 0); break;
+                }
+                
+                juce::FloatVectorOperations::multiply (wet.data(), getPostGain(modelType, drive), period);
+                
+                if (modelType == DistortionModel::cSoft)
+                    juce::FloatVectorOperations::clip (wet.data(), wet.data(), -clipLevel, clipLevel, period);
+            }
+            
+            //The dc blocker takes the offset out before anyone hears it, so only the rest counts
+            auto mean = 0.0;
+            
+            for (auto sample : wet)
+                mean += (double) sample;
+            
+            mean /= period;
+            gain = static_cast<SampleType> (std::sqrt(juce::jmax(0.0, getEnergy(wet.data(), period) / period - mean * mean)) / inputRms);
+        }
+    }
+    
+    return table;
+}
+
+template <typename SampleType>
+SampleType Distortion<SampleType>::getTableGain(DistortionModel model, SampleType drive) const noexcept
+{
+    if (_autoGainTable == nullptr)
+        return SampleType (1);
+    
+    const auto& row = _autoGainTable->gains[(size_t) static_cast<int> (model)];
+    
+    const auto position = juce::jlimit(SampleType (0), SampleType (autoGainSteps - 1), drive / autoGainStepDb);
+    const auto index = juce::jmin((int) position, autoGainSteps - 2);
+    const auto fraction = position - SampleType (index);
+    
+    return row[(size_t) index] + fraction * (row[(size_t) index + 1] - row[(size_t) index]);
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::updateAutoGain(size_t activeLanes) noexcept
+{
+    //Dry and wet add up roughly in phase, so the mixed level is the blend of the two gains, averaged over the lanes
+    auto level = SampleType (0);
+    
+    for (size_t i = 0; i < activeLanes; ++i)
+    {
+        const auto& lane = _lanes[i];
+        const auto mix = lane.mix.getCurrentValue();
+        const auto drive = lane.input.getCurrentValue();
+        const auto blend = _blendModel != lane.model ? _blend.getCurrentValue() : SampleType (0);
+        
+        const auto modelGain = getTableGain(lane.model, drive);
+        const auto wetGain = modelGain + blend * (getTableGain(_blendModel, drive) - modelGain);
+        
+        level += (SampleType (1) - mix) + mix * wetGain;
+    }
+    
+    level = juce::jmax(SampleType (1.0e-3), level / SampleType (activeLanes));
+    
+    _tableGain = SampleType (1) / level;
+    
+    const auto compensation = _residualDb - juce::Decibels::gainToDecibels(level);
+    
+    //Small moves are not worth restarting the output ramp for
+    if (std::abs(compensation - _autoGainDb) > SampleType (0.05))
+    {
+        _autoGainDb = compensation;
+        _output.setTargetValue(juce::Decibels::decibelsToGain(_userOutput + _autoGainDb));
+    }
+}
+
+template <typename SampleType>
+void Distortion<SampleType>::trackLoudness(double inputEnergy, double outputEnergy, size_t numSamples) noexcept
+{
+    constexpr double timeConstant = 3.0;
+    constexpr double silence = 1.0e-7;
+    constexpr SampleType maxResidualDb = SampleType (12);
+    
+    if (numSamples == 0 || inputEnergy < silence * (double) numSamples)
+        return;
+    
+    //Once per block, the output side already corrected by the table
+    const auto tableGain = (double) _tableGain;
+    const auto coefficient = std::exp(-(double) numSamples / (timeConstant * _sampleRate * (double) _numChannels));
+    
+    _inputPower  = coefficient * _inputPower  + (1.0 - coefficient) * inputEnergy / (double) numSamples;
+    _outputPower = coefficient * _outputPower + (1.0 - coefficient) * outputEnergy * tableGain * tableGain / (double) numSamples;
+    
+    if (_outputPower > silence)
+        _residualDb = juce::jlimit(-maxResidualDb, maxResidualDb, static_cast<SampleType> (10.0 * std::log10(_inputPower / _outputPower)));
+}
+
+//Setting up the types of variables that the typename template can have
+template class Distortion<float>;
+template class Distortion<double>;
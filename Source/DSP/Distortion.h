@@ -1,197 +1,930 @@
-/*
-  ==============================================================================
-
-    Distortion.h
-    Created: 12 Mar 2023 12:36:54pm
-    Author:  Alperen Kurbetci
-
-  ==============================================================================
-*/
-
-#pragma once
-#include <JuceHeader.h>
-
-template <typename SampleType>
-
-class Distortion
-
-{
-public:
-    
-    Distortion();
-    
-    void prepare(juce::dsp::ProcessSpec& spec);
-    
-    void reset();
-    
-    /*
-     The main processing for the incoming samples in ProcessBlock of the AuidoProcessor
-     */
-    template <typename ProcessContext>
-    void process(const ProcessContext& context) noexcept
-    {
-        //Coppied from juce_Compressor.h
-        const auto& inputBlock = context.getInputBlock();
-        auto& outputBlock      = context.getOutputBlock();
-        const auto numChannels = outputBlock.getNumChannels();
-        const auto numSamples  = outputBlock.getNumSamples();
-
-        jassert (inputBlock.getNumChannels() == numChannels);
-        jassert (inputBlock.getNumSamples()  == numSamples);
-
-        
-        for (size_t channel = 0; channel < numChannels; ++channel)
-        {
-            auto* inputSamples  = inputBlock .getChannelPointer (channel);
-            auto* outputSamples = outputBlock.getChannelPointer (channel);
-
-            for (size_t i = 0; i < numSamples; ++i)
-                
-            {
-                outputSamples[i] = dcFilter.processSample(channel,outputSamples[i] );
-                outputSamples[i] = processSample(inputSamples[i], channel);
-            }
-                
-        }
-        
-    }
-    
-    /*
-     Here call the specific process for the chosen Distortion Model
-     */
-    SampleType processSample(SampleType inputSample, int channel) noexcept
-    {
-        switch(_model)
-        {
-            case DistortionModel::cHard:
-        {
-            return processHardClip (inputSample);
-            break;
-        }
-        
-        
-            case DistortionModel::cSoft:
-        {
-            return processSoftClip (inputSample);
-            break;
-        }
-        
-        
-            case DistortionModel::cSaturation:
-        {
-          //Added channel to prepare the code if in future, a need to handle both channels occurs
-            return processSaturation(inputSample, channel);
-            break;
-        }
-
-        }
-    }
-    
-    ///Hard Clipping algorithm
-    SampleType processHardClip (SampleType inputSample)
-    {
-        // To drive the signal we multiply
-        // getNextValue() funtion is due to _input being a smoothed value
-        
-        auto wetSignal = inputSample * juce::Decibels::decibelsToGain(_input.getNextValue());
-        
-        if (std::abs(wetSignal) > 0.99)
-        
-        {
-            wetSignal *= 0.99 / std::abs(wetSignal);
-        }
-        
-        auto mix = ((1.0 - _mix.getNextValue()) * inputSample) + wetSignal * _mix.getNextValue();
-        
-        //Here, we can use the wetSignal instead of the mix, programmer's choice
-
-        return mix * juce::Decibels::decibelsToGain(_output.getNextValue());
-        
-    }
-     ///Soft Clipping Algortihm with a hard clipping statement to adjust the signal no to go way above when the drive is adjusted.
-    SampleType processSoftClip (SampleType inputSample)
-    {
-        auto wetSignal = inputSample * juce::Decibels::decibelsToGain(_input.getNextValue());
-        
-        //tan, atan, tanh, attanh
-        wetSignal = piDi * std::atan(wetSignal);
-        
-        wetSignal *= 2.0;
-        
-        wetSignal *= juce::Decibels::decibelsToGain(_input.getNextValue() * -0.25);
-        
-        if (std::abs(wetSignal) > 0.99)
-        
-        {
-            wetSignal *= 0.99 / std::abs(wetSignal);
-        }
-        
-        auto mix = (1.0 - _mix.getNextValue()) * inputSample + wetSignal * _mix.getNextValue();
-        
-        //Here, we can use the wetSignal instead of the mix, programmer's choice
-
-        return mix * juce::Decibels::decibelsToGain(_output.getNextValue());
-    }
-    
-   ///Saturation Algortihm with a hard clipping statement to adjust the signal no to go way above when the drive is adjusted.
-    SampleType processSaturation(SampleType inputSample , int channel)
-    {
-        auto drive = juce::jmap(_input.getNextValue(), 0.0f, 24.0f, 0.0f, 6.0f);
-        
-        auto wetSignal = inputSample * juce::Decibels::decibelsToGain(drive);
-        
-        if(wetSignal >= 0.0)
-        {
-            wetSignal = std::tanh(wetSignal);
-        }
-        else
-        {
-            wetSignal = std::tanh(std::sinh(wetSignal)) - 0.2 * wetSignal * std::sin(juce::MathConstants<float>::pi * wetSignal);
-        }
-        
-        wetSignal *= 1.15;
-        wetSignal *= juce::Decibels::decibelsToGain(_input.getNextValue() * -0.05);
-        
-        auto mix = (1.0 - _mix.getNextValue()) * inputSample + wetSignal * _mix.getNextValue();
-
-        return mix * juce::Decibels::decibelsToGain(_output.getNextValue());
-
-    }
-    
-  //Used enum to attenuate the models (better than string)
-    enum class DistortionModel
-    {
-        cHard,
-        cSoft,
-        cSaturation
-    };
-    
-    
-    //Fucntions to choose the Dist Models
-    void setDrive(SampleType newDrive);
-    void setMix(SampleType newMix);
-    void setOutput(SampleType newOutput);
-    
-    void setDistortionModel(DistortionModel newModel);
-    
-    
-    
-private:
-  
-  //Used smoothed values to avoid audio glitches
-    juce::SmoothedValue<float> _input;
-    juce::SmoothedValue<float> _mix;
-    juce::SmoothedValue<float> _output;
-    
-    //To control the overall signal (In proess())
-    juce::dsp::LinkwitzRileyFilter<float> dcFilter;
-    
-  //For Soft Clipping
-    float piDi =  2.0 / juce::MathConstants<float>::pi;
-    
-  //Sample Rate
-    float _sampleRate = 48000.0f;
-  
-  //Defauld model choice is Har Clipping
-    DistortionModel _model = DistortionModel::cHard;
-};
+/*
+  ==============================================================================
+
+    Distortion.h
+    Created: 12 Mar 2023 12:36:54pm
+    Author:  Alperen Kurbetci
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "NeuralNetwork.h"
+#include "DiodeClipper.h"
+#include "TapeHysteresis.h"
+#include "ChebyshevShaper.h"
+#include "BiasedShaper.h"
+#include "ModulationMatrix.h"
+#include "SharedResourceCache.h"
+#include "TraceRecorder.h"
+
+template <typename SampleType>
+
+class Distortion
+
+{
+public:
+    
+  //Used enum to attenuate the models (better than string)
+    enum class DistortionModel
+    {
+        cHard,
+        cSoft,
+        cSaturation,
+        cNeural,
+        cDiode,
+        cTape,
+        cHarmonics,
+        cFold,
+        cTriode
+    };
+    
+    //How the channels share the parameters: all on lane 0, left / right on lanes 0 / 1, or mid / side on lanes 0 / 1
+    enum class StereoMode
+    {
+        cLinked,
+        cDualMono,
+        cMidSide
+    };
+    
+    static constexpr size_t numLanes = 2;
+    
+    //The lane model is the first stage, up to maxStages - 1 more can follow it
+    static constexpr int maxStages = 4;
+    
+    //The ranges of the drive and output parameters, the modulated values are held inside them
+    static constexpr SampleType minDriveDb  = SampleType (0);
+    static constexpr SampleType maxDriveDb  = SampleType (24);
+    static constexpr SampleType minOutputDb = SampleType (-24);
+    static constexpr SampleType maxOutputDb = SampleType (24);
+    
+    Distortion();
+    
+    void prepare(juce::dsp::ProcessSpec& spec);
+    
+    void reset();
+    
+    /*
+     The main processing for the incoming samples in ProcessBlock of the AuidoProcessor
+     */
+    template <typename ProcessContext>
+    void process(const ProcessContext& context) noexcept
+    {
+        //Coppied from juce_Compressor.h
+        const auto& inputBlock = context.getInputBlock();
+        auto& outputBlock      = context.getOutputBlock();
+        const auto numChannels = outputBlock.getNumChannels();
+        const auto numSamples  = outputBlock.getNumSamples();
+
+        jassert (inputBlock.getNumChannels() == numChannels);
+        jassert (inputBlock.getNumSamples()  == numSamples);
+        jassert (_maxBlockSize > 0);
+
+        if (_maxBlockSize == 0)
+            return;
+
+        //A harmonic design built since the last block is used from here on, for every channel alike
+        _harmonics.acquireDesign();
+        
+        if (_requestedStages != _numStages)
+            updateNumStages();
+        
+        //Mid-side needs both channels, with fewer it runs like linked
+        const auto midSide = _stereoMode == StereoMode::cMidSide && numChannels >= 2;
+        
+        //The modulation is given for exactly this block, its control points are worked out once here
+        _modulated = _modulation.isActive() && _modulation.numSamples == numSamples && numSamples <= _maxBlockSize;
+        
+        //Auto gain moves the output target, so it goes before the modulation bakes the output into its control points
+        if (_autoGain)
+            updateAutoGain (getNumActiveLanes (numChannels));
+        
+        if (_modulated)
+            prepareModulation (numSamples, getNumActiveLanes (numChannels));
+        
+        _modulation = {};
+
+        //The ramps and the wet signal live in scratch sized at prepare(), longer blocks go in pieces
+        for (size_t start = 0; start < numSamples; start += _maxBlockSize)
+        {
+            const auto count = juce::jmin (_maxBlockSize, numSamples - start);
+            
+            if (! midSide)
+            {
+                processChunk (inputBlock, outputBlock, start, count);
+                continue;
+            }
+            
+            //Encoded in the output, which then is the input of the chain as well
+            auto outputChunk = outputBlock.getSubBlock (start, count);
+            
+            if (inputBlock.getChannelPointer (0) != outputBlock.getChannelPointer (0))
+                outputChunk.copyFrom (inputBlock.getSubBlock (start, count));
+            
+            encodeMidSide (outputBlock.getChannelPointer (0) + start, outputBlock.getChannelPointer (1) + start, (int) count);
+            processChunk (outputBlock, outputBlock, start, count);
+            decodeMidSide (outputBlock.getChannelPointer (0) + start, outputBlock.getChannelPointer (1) + start, (int) count);
+        }
+    }
+    
+    /*
+     One piece of the block, every stage is a pass over a whole channel:
+     drive -> model -> make up gain -> clip -> blend -> cascade -> dc blocker -> mix -> output.
+     The smoothers are read once per piece so every channel of a lane sees the same ramp,
+     and a settled smoother turns its pass into a single constant gain.
+     Linked runs every channel on lane 0, dual mono and mid-side give the second channel
+     (right or side) lane 1. The passes run along time, so a lane costs the same whatever
+     the mode, the second lane only adds its ramps.
+     */
+    template <typename InputBlock, typename OutputBlock>
+    void processChunk (const InputBlock& inputBlock, OutputBlock& outputBlock, size_t start, size_t count) noexcept
+    {
+        const auto numSamples = (int) count;
+        const auto numChannels = outputBlock.getNumChannels();
+        const auto activeLanes = getNumActiveLanes (numChannels);
+        
+        auto* outputGains = getScratch (scratchOutput);
+        auto* blendValues = getScratch (scratchBlend);
+        auto* wetSignal   = getScratch (scratchWet);
+        auto* blendSignal = getScratch (scratchBlendWet);
+        
+        //The second model only runs where the blend is above zero
+        const auto blendRamping = _modulated ? fillModulatedRamp (scratchBlend, blendValues, start, count)
+                                             : fillRamp (_blend, blendValues, count);
+        const auto blendOn = (blendRamping ? juce::FloatVectorOperations::findMaximum (blendValues, numSamples) : blendValues[0]) > SampleType (0);
+        
+        LaneRamps ramps[numLanes];
+        
+        for (size_t lane = 0; lane < activeLanes; ++lane)
+        {
+            auto& ramp = ramps[lane];
+            ramp.preGains       = getScratch (lane * scratchPerLane + scratchPreGain);
+            ramp.postGains      = getScratch (lane * scratchPerLane + scratchPostGain);
+            ramp.mixValues      = getScratch (lane * scratchPerLane + scratchMix);
+            ramp.blendPreGains  = getScratch (lane * scratchPerLane + scratchBlendPreGain);
+            ramp.blendPostGains = getScratch (lane * scratchPerLane + scratchBlendPostGain);
+            ramp.blending = blendOn && _blendModel != _lanes[lane].model;
+            
+            if (_modulated)
+            {
+                fillModulatedRamps (lane, ramp, start, count);
+                continue;
+            }
+            
+            ramp.driveRamping = fillDriveGains (_lanes[lane], ramp, count);
+            ramp.mixRamping   = fillRamp (_lanes[lane].mix, ramp.mixValues, count);
+        }
+        
+        const auto outputRamping = _modulated ? fillModulatedRamp (scratchOutput, outputGains, start, count)
+                                              : fillOutputGains (outputGains, count);
+        
+        if (_numStages > 1)
+            fillStageRamps (count);
+        
+        auto inputEnergy = 0.0;
+        auto outputEnergy = 0.0;
+        
+        for (size_t channel = 0; channel < numChannels; ++channel)
+        {
+            auto* inputSamples  = inputBlock .getChannelPointer (channel) + start;
+            auto* outputSamples = outputBlock.getChannelPointer (channel) + start;
+            
+            const auto laneIndex = juce::jmin (channel, activeLanes - 1);
+            const auto model = _lanes[laneIndex].model;
+            const auto& ramp = ramps[laneIndex];
+            
+            //The mix may overwrite the input, measure it now
+            if (_autoGain)
+                inputEnergy += getEnergy (inputSamples, numSamples);
+            
+            processModel (inputSamples, wetSignal, ramp.preGains, ramp.postGains, ramp.driveRamping, numSamples, (int) channel, model);
+            
+            if (ramp.blending)
+            {
+                processModel (inputSamples, blendSignal, ramp.blendPreGains, ramp.blendPostGains, ramp.driveRamping, numSamples, (int) channel, _blendModel);
+                processBlend (wetSignal, blendSignal, blendValues, blendRamping, numSamples);
+            }
+            
+            if (_numStages > 1)
+                processCascade (wetSignal, numSamples, (int) channel);
+            
+            //The dc the models make (bias, asymmetry), before the dry signal is mixed back in
+            processDcBlocker (wetSignal, numSamples, (int) channel);
+            
+            processMix (inputSamples, outputSamples, wetSignal, ramp.mixValues, ramp.mixRamping, numSamples);
+            
+            if (_autoGain)
+                outputEnergy += getEnergy (outputSamples, numSamples);
+            
+            //Output
+            if (outputRamping)
+                juce::FloatVectorOperations::multiply (outputSamples, outputGains, numSamples);
+            else if (outputGains[0] != SampleType (1))
+                juce::FloatVectorOperations::multiply (outputSamples, outputGains[0], numSamples);
+        }
+        
+        if (_autoGain)
+            trackLoudness (inputEnergy, outputEnergy, count * numChannels);
+    }
+    
+    ///M = (L + R) / 2, S = (L - R) / 2 in place, the wet scratch holds a copy of L meanwhile
+    void encodeMidSide (SampleType* left, SampleType* right, int numSamples) noexcept
+    {
+        auto* copy = getScratch (scratchWet);
+        
+        juce::FloatVectorOperations::copy (copy, left, numSamples);
+        juce::FloatVectorOperations::add (left, right, numSamples);
+        juce::FloatVectorOperations::multiply (left, SampleType (0.5), numSamples);
+        juce::FloatVectorOperations::subtract (right, copy, left, numSamples);
+    }
+    
+    ///L = M + S, R = M - S in place
+    void decodeMidSide (SampleType* mid, SampleType* side, int numSamples) noexcept
+    {
+        auto* copy = getScratch (scratchWet);
+        
+        juce::FloatVectorOperations::copy (copy, mid, numSamples);
+        juce::FloatVectorOperations::add (mid, side, numSamples);
+        juce::FloatVectorOperations::subtract (side, copy, side, numSamples);
+    }
+    
+    ///Drive -> model -> make up gain -> clip from the input into the wet buffer
+    void processModel (const SampleType* inputSamples, SampleType* wetSignal, const SampleType* preGains, const SampleType* postGains,
+                       bool driveRamping, int numSamples, int channel, DistortionModel model) noexcept
+    {
+        //Drive
+        if (driveRamping)
+            juce::FloatVectorOperations::multiply (wetSignal, inputSamples, preGains, numSamples);
+        else
+            juce::FloatVectorOperations::multiply (wetSignal, inputSamples, preGains[0], numSamples);
+        
+        processWetSignal (wetSignal, numSamples, channel, model);
+        
+        //Make up gain, only the soft clipper and the saturation have one
+        if (model == DistortionModel::cSoft || model == DistortionModel::cSaturation)
+        {
+            if (driveRamping)
+                juce::FloatVectorOperations::multiply (wetSignal, postGains, numSamples);
+            else
+                juce::FloatVectorOperations::multiply (wetSignal, postGains[0], numSamples);
+        }
+        
+        //The soft clipper gets its final hard clip after the make up gain, unless a limiter takes care of the ceiling
+        if (model == DistortionModel::cSoft && _safetyClip)
+            juce::FloatVectorOperations::clip (wetSignal, wetSignal, -clipLevel, clipLevel, numSamples);
+    }
+    
+    /*
+     Here call the specific process for the chosen Distortion Model, the wet signal is
+     already driven and is shaped in place
+     */
+    void processWetSignal (SampleType* wetSignal, int numSamples, int channel, DistortionModel model) noexcept
+    {
+        TraceRecorder::Scope span (_trace, getTraceName (model));
+        
+        switch(model)
+        {
+            case DistortionModel::cHard:
+        {
+            processHardClip (wetSignal, numSamples);
+            break;
+        }
+        
+        
+            case DistortionModel::cSoft:
+        {
+            processSoftClip (wetSignal, numSamples);
+            break;
+        }
+        
+        
+            case DistortionModel::cSaturation:
+        {
+          //Added channel to prepare the code if in future, a need to handle both channels occurs
+            processSaturation(wetSignal, numSamples, channel);
+            break;
+        }
+
+            case DistortionModel::cDiode:
+        {
+            processDiodeClipper(wetSignal, numSamples, channel);
+            break;
+        }
+
+            case DistortionModel::cTape:
+        {
+            processTape(wetSignal, numSamples, channel);
+            break;
+        }
+
+            case DistortionModel::cHarmonics:
+        {
+            processHarmonics(wetSignal, numSamples);
+            break;
+        }
+
+            case DistortionModel::cFold:
+        {
+            _folder.process(wetSignal, numSamples, channel);
+            break;
+        }
+
+            case DistortionModel::cTriode:
+        {
+            _triode.process(wetSignal, numSamples, channel);
+            break;
+        }
+
+            case DistortionModel::cNeural:
+        {
+            processNeural(wetSignal, numSamples, channel);
+            break;
+        }
+
+        }
+    }
+    
+    ///Hard Clipping algorithm
+    void processHardClip (SampleType* wetSignal, int numSamples) noexcept
+    {
+        juce::FloatVectorOperations::clip (wetSignal, wetSignal, -clipLevel, clipLevel, numSamples);
+    }
+    
+     ///Soft Clipping Algortihm, the hard clipping statement that keeps the signal from going way above when the drive is adjusted runs after the make up gain
+    void processSoftClip (SampleType* wetSignal, int numSamples) noexcept
+    {
+        //tan, atan, tanh, attanh
+        for (int i = 0; i < numSamples; ++i)
+            wetSignal[i] = std::atan(wetSignal[i]);
+    }
+    
+   ///Saturation Algortihm, tanh on the positive half and a folded curve on the negative half
+    void processSaturation(SampleType* wetSignal, int numSamples, int channel) noexcept
+    {
+        juce::ignoreUnused (channel);
+        
+        for (int i = 0; i < numSamples; ++i)
+            wetSignal[i] = saturateSample (wetSignal[i]);
+    }
+    
+    static SampleType saturateSample (SampleType x) noexcept
+    {
+        if(x >= SampleType (0))
+            return std::tanh(x);
+        
+        return std::tanh(std::sinh(x)) - SampleType (0.2) * x * std::sin(juce::MathConstants<SampleType>::pi * x);
+    }
+    
+    ///Diode clipper circuit, the drive sets how hard the input swings into the diodes
+    void processDiodeClipper(SampleType* wetSignal, int numSamples, int channel) noexcept
+    {
+        //Each channel has its own capacitor voltage
+        for (int i = 0; i < numSamples; ++i)
+            wetSignal[i] = _diodeClipper.processSample(wetSignal[i], channel);
+    }
+    
+    ///Tape hysteresis, the drive sets how far the field swings into saturation
+    void processTape(SampleType* wetSignal, int numSamples, int channel) noexcept
+    {
+        _tape.process(wetSignal, numSamples, channel);
+    }
+    
+    ///Harmonic designer, the drive sets how much of the full scale design the signal reaches
+    void processHarmonics(SampleType* wetSignal, int numSamples) noexcept
+    {
+        _harmonics.process(wetSignal, numSamples);
+    }
+    
+    ///One pole high-pass at dcCutoff on the wet signal, one pass per block and channel
+    void processDcBlocker (SampleType* wetSignal, int numSamples, int channel) noexcept
+    {
+        if ((size_t) channel >= _numChannels)
+            return;
+        
+        TraceRecorder::Scope span (_trace, "DC blocker");
+        
+        auto* state = _dcState.get() + 2 * (size_t) channel;
+        auto input = state[0];
+        auto output = state[1];
+        const auto pole = _dcPole;
+        
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto x = wetSignal[i];
+            output = x - input + pole * output;
+            input = x;
+            wetSignal[i] = output;
+        }
+        
+        state[0] = input;
+        state[1] = output;
+    }
+    
+    ///Neural capture, the network runs in float whatever the processing precision. Every stage has its own hidden state.
+    void processNeural (SampleType* wetSignal, int numSamples, int channel, size_t stage = 0) noexcept
+    {
+        //Without a model loaded the capture is a clean gain stage
+        if (_network == nullptr || (size_t) channel >= _numChannels)
+            return;
+        
+        auto* state = _neuralState.get() + (stage * _numChannels + (size_t) channel) * NeuralNetworkBase::maxStateSize;
+        
+        if constexpr (std::is_same_v<SampleType, float>)
+        {
+            _network->process (state, wetSignal, wetSignal, numSamples);
+        }
+        else
+        {
+            auto* buffer = _neuralBuffer.get();
+            
+            for (int i = 0; i < numSamples; ++i)
+                buffer[i] = static_cast<float> (wetSignal[i]);
+            
+            _network->process (state, buffer, buffer, numSamples);
+            
+            for (int i = 0; i < numSamples; ++i)
+                wetSignal[i] = static_cast<SampleType> (buffer[i]);
+        }
+    }
+    
+    /*
+     Stages 2 - maxStages on the wet signal, after the blend: a coupling high-pass and the tone
+     low-pass between the stages, then drive -> model -> make up gain -> clip like the first.
+     Runs of stages with a per sample model are fused into one pass, each sample goes through
+     all of them in registers and is written back once. Tape and neural captures carry their
+     own loop, they take the wet buffer between two fused runs. Every stage runs inside the
+     one oversampled block, the resampling is shared.
+     */
+    void processCascade (SampleType* wetSignal, int numSamples, int channel) noexcept
+    {
+        TraceRecorder::Scope span (_trace, "Cascade");
+        
+        const auto numExtraStages = (size_t) _numStages - 1;
+        
+        for (size_t first = 0; first < numExtraStages;)
+        {
+            auto last = first;
+            
+            while (last < numExtraStages && isSampleModel (_stages[last].model))
+                ++last;
+            
+            if (last > first)
+                processStagesFused (wetSignal, numSamples, channel, first, last);
+            
+            if (last < numExtraStages)
+            {
+                processStageBlock (wetSignal, numSamples, channel, last);
+                ++last;
+            }
+            
+            first = last;
+        }
+    }
+    
+    ///Models with a sample by sample form, the rest run their own loop
+    static bool isSampleModel (DistortionModel model) noexcept
+    {
+        return model != DistortionModel::cTape && model != DistortionModel::cNeural;
+    }
+    
+    ///Stages first - last in one pass
+    void processStagesFused (SampleType* wetSignal, int numSamples, int channel, size_t first, size_t last) noexcept
+    {
+        //Filter states in locals for the length of the pass
+        SampleType highPassIn[maxStages], highPassOut[maxStages], lowPassOut[maxStages];
+        
+        for (auto stage = first; stage < last; ++stage)
+        {
+            const auto* filter = getStageFilter (stage, channel);
+            highPassIn[stage]  = filter[0];
+            highPassOut[stage] = filter[1];
+            lowPassOut[stage]  = filter[2];
+        }
+        
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto x = wetSignal[i];
+            
+            for (auto stage = first; stage < last; ++stage)
+            {
+                const auto& ramp = _stageRamps[stage];
+                
+                highPassOut[stage] = ramp.highPass * (highPassOut[stage] + x - highPassIn[stage]);
+                highPassIn[stage] = x;
+                lowPassOut[stage] += ramp.lowPass * (highPassOut[stage] - lowPassOut[stage]);
+                
+                x = lowPassOut[stage] * (ramp.preGain + (SampleType) i * ramp.preStep);
+                x = shapeStageSample (x, stage, channel);
+                x *= ramp.postGain + (SampleType) i * ramp.postStep;
+                
+                if (_stages[stage].model == DistortionModel::cSoft && _safetyClip)
+                    x = juce::jlimit (-clipLevel, clipLevel, x);
+            }
+            
+            wetSignal[i] = x;
+        }
+        
+        for (auto stage = first; stage < last; ++stage)
+        {
+            auto* filter = getStageFilter (stage, channel);
+            filter[0] = highPassIn[stage];
+            filter[1] = highPassOut[stage];
+            filter[2] = lowPassOut[stage];
+        }
+    }
+    
+    ///A stage whose model runs its own loop, the filters and drive go in a pass before it
+    void processStageBlock (SampleType* wetSignal, int numSamples, int channel, size_t stage) noexcept
+    {
+        const auto& ramp = _stageRamps[stage];
+        auto* filter = getStageFilter (stage, channel);
+        auto highPassIn = filter[0], highPassOut = filter[1], lowPassOut = filter[2];
+        
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto x = wetSignal[i];
+            highPassOut = ramp.highPass * (highPassOut + x - highPassIn);
+            highPassIn = x;
+            lowPassOut += ramp.lowPass * (highPassOut - lowPassOut);
+            wetSignal[i] = lowPassOut * (ramp.preGain + (SampleType) i * ramp.preStep);
+        }
+        
+        filter[0] = highPassIn;
+        filter[1] = highPassOut;
+        filter[2] = lowPassOut;
+        
+        //Neither model has a make up gain
+        if (_stages[stage].model == DistortionModel::cTape)
+            _stages[stage].tape.process (wetSignal, numSamples, channel);
+        else
+            processNeural (wetSignal, numSamples, channel, stage + 1);
+    }
+    
+    SampleType shapeStageSample (SampleType x, size_t stage, int channel) noexcept
+    {
+        switch (_stages[stage].model)
+        {
+            case DistortionModel::cHard:       return juce::jlimit (-clipLevel, clipLevel, x);
+            case DistortionModel::cSoft:       return std::atan (x);
+            case DistortionModel::cSaturation: return saturateSample (x);
+            case DistortionModel::cDiode:      return _stages[stage].diodeClipper.processSample (x, channel);
+            case DistortionModel::cHarmonics:  return _harmonics.processSample (x);
+            case DistortionModel::cFold:       return _stages[stage].folder.processSample (x, channel);
+            case DistortionModel::cTriode:     return _stages[stage].triode.processSample (x, channel);
+            case DistortionModel::cTape:
+            case DistortionModel::cNeural:     break;
+        }
+        
+        return x;
+    }
+    
+    ///Model crossfade, wet = wet + blend * (blendWet - wet). The blend buffer is used as scratch.
+    void processBlend (SampleType* wetSignal, SampleType* blendSignal, const SampleType* blendValues, bool blendRamping, int numSamples) noexcept
+    {
+        if (! blendRamping && blendValues[0] >= SampleType (1))
+        {
+            juce::FloatVectorOperations::copy (wetSignal, blendSignal, numSamples);
+            return;
+        }
+        
+        juce::FloatVectorOperations::subtract (blendSignal, wetSignal, numSamples);
+        
+        if (blendRamping)
+        {
+            juce::FloatVectorOperations::multiply (blendSignal, blendValues, numSamples);
+            juce::FloatVectorOperations::add (wetSignal, blendSignal, numSamples);
+        }
+        else
+        {
+            juce::FloatVectorOperations::addWithMultiply (wetSignal, blendSignal, blendValues[0], numSamples);
+        }
+    }
+    
+    ///Wet/dry mix, output = input + mix * (wet - input). The wet buffer is used as scratch.
+    void processMix (const SampleType* inputSamples, SampleType* outputSamples, SampleType* wetSignal,
+                     const SampleType* mixValues, bool mixRamping, int numSamples) noexcept
+    {
+        if (mixRamping)
+        {
+            juce::FloatVectorOperations::subtract (wetSignal, inputSamples, numSamples);
+            juce::FloatVectorOperations::multiply (wetSignal, mixValues, numSamples);
+            juce::FloatVectorOperations::add (outputSamples, wetSignal, inputSamples, numSamples);
+            return;
+        }
+        
+        const auto mix = mixValues[0];
+        
+        if (mix >= SampleType (1))
+        {
+            juce::FloatVectorOperations::copy (outputSamples, wetSignal, numSamples);
+        }
+        else if (mix <= SampleType (0))
+        {
+            if (outputSamples != inputSamples)
+                juce::FloatVectorOperations::copy (outputSamples, inputSamples, numSamples);
+        }
+        else
+        {
+            juce::FloatVectorOperations::multiply (outputSamples, inputSamples, SampleType (1) - mix, numSamples);
+            juce::FloatVectorOperations::addWithMultiply (outputSamples, wetSignal, mix, numSamples);
+        }
+    }
+    
+    //Fucntions to choose the Dist Models, drive, mix and model can be set per lane
+    void setDrive(SampleType newDrive, size_t lane = 0);
+    void setMix(SampleType newMix, size_t lane = 0);
+    void setOutput(SampleType newOutput);
+    
+    void setDistortionModel(DistortionModel newModel, size_t lane = 0);
+    void setStereoMode(StereoMode newMode);
+    
+    //Keeps the loudness close to the input whatever the drive, on top of the output setting
+    void setAutoGain(bool shouldCompensate);
+    
+    //Crossfade from the lane models to a second model, 0 - 1, on every lane
+    void setBlendModel(DistortionModel newModel);
+    void setBlend(SampleType newBlend);
+    
+    //Tape model settings, see TapeHysteresis. Every tape stage shares them.
+    void setTapeBias(SampleType newBias) noexcept;
+    void setTapeSaturation(SampleType newSaturation) noexcept;
+    void setTapeSolver(typename TapeHysteresis<SampleType>::Solver newSolver) noexcept;
+    
+    //Wavefolder shape (sine or triangle fold) and the operating point of the folder and the triode, see BiasedShaper
+    void setFoldShape(typename BiasedShaper<SampleType>::Curve newShape) noexcept;
+    void setShaperBias(SampleType newBias) noexcept;
+    
+    //Cascade: 1 - maxStages stages in all, the lane model is the first. Stage settings are for stages 2 - maxStages (index 0 - maxStages - 2)
+    void setNumStages(int newNumStages) noexcept;
+    void setStageModel(size_t stage, DistortionModel newModel) noexcept;
+    void setStageDrive(size_t stage, SampleType newDrive) noexcept;
+    
+    //Cutoff of the low-pass in front of the stage, in Hz
+    void setStageTone(size_t stage, SampleType newCutoff) noexcept;
+    
+    //Harmonic designer levels (harmonics 2 - ChebyshevShaper::maxHarmonic), the polynomial is built on the design thread
+    void setHarmonics(const typename ChebyshevShaper<SampleType>::Levels& levels) noexcept { _harmonics.setHarmonics(levels); }
+    
+    //Message thread: offline the polynomial is built at the next block instead, so every render is the same
+    void setNonRealtime(bool shouldBeNonRealtime) { _harmonics.setNonRealtime(shouldBeNonRealtime); }
+    
+    /*
+     log2 of the oversampling the models that are heard need: the harmonic designer exactly what
+     its polynomial needs, every other model defaultOrder. The blend model counts while the blend
+     is open or modulated.
+     */
+    size_t getOversamplingOrder(size_t defaultOrder, bool blendModulated) const noexcept;
+    
+    //Control rate offsets from the ModulationMatrix, used by the next process() call only
+    void setModulation(const ModulationMatrix::Block& modulation) noexcept;
+    
+    //Off when a limiter after the distortion holds the ceiling instead
+    void setSafetyClip(bool shouldClip) noexcept;
+    
+    //True when a lane that is heard, or the blend, runs this model
+    bool usesModel(DistortionModel model) const noexcept;
+    
+    //Audio thread only, the network itself is owned by the NeuralModelLoader
+    void setNeuralNetwork(const NeuralNetworkBase* newNetwork) noexcept;
+    
+    //What this instance allocated in prepare(), the shared auto gain table not included
+    size_t getMemoryFootprintBytes() const noexcept;
+    
+    //Spans for the model kernels and the dc filter, nullptr for none
+    void setTraceRecorder(TraceRecorder* recorder) noexcept { _trace = recorder; }
+    
+    
+    
+private:
+  
+    /*
+     Per piece ramps, each returns false when its smoother has settled and only
+     the first entry has been written
+     */
+    struct Lane;
+    struct LaneRamps;
+    bool fillDriveGains (Lane& lane, LaneRamps& ramp, size_t count) noexcept;
+    bool fillRamp (juce::SmoothedValue<SampleType>& smoother, SampleType* values, size_t count) noexcept;
+    bool fillOutputGains (SampleType* outputGains, size_t count) noexcept;
+    void fillStageRamps (size_t count) noexcept;
+    
+    //Audio thread, takes the stage count from setNumStages() and clears the stages coming in
+    void updateNumStages() noexcept;
+    
+    static const char* getTraceName (DistortionModel model) noexcept
+    {
+        switch (model)
+        {
+            case DistortionModel::cHard:       return "Hard clip";
+            case DistortionModel::cSoft:       return "Soft clip";
+            case DistortionModel::cSaturation: return "Saturation";
+            case DistortionModel::cDiode:      return "Diode clipper";
+            case DistortionModel::cTape:       return "Tape";
+            case DistortionModel::cHarmonics:  return "Harmonics";
+            case DistortionModel::cFold:       return "Wavefolder";
+            case DistortionModel::cTriode:     return "Triode";
+            case DistortionModel::cNeural:     return "Neural capture";
+        }
+        
+        return "Distortion";
+    }
+    
+    ///Gain into the model and make up gain after it, both from the drive in dB
+    static SampleType getPreGain (DistortionModel model, SampleType drive) noexcept;
+    static SampleType getPostGain (DistortionModel model, SampleType drive) noexcept;
+    
+    /*
+     Auto gain, all of it per block. The table holds the wet gain of every model at every
+     drive step for a sine at a typical DI level. It only depends on the precision and the
+     sample rate, so prepare() takes it from the SharedResourceCache and the first
+     instance at a rate works it out for all the others. The tracker
+     compares the slow input and output power (output already corrected by the table)
+     and covers what the table can not know: the program material and the neural capture.
+     */
+    struct AutoGainTable;
+    std::shared_ptr<const AutoGainTable> buildAutoGainTable();
+    void updateAutoGain (size_t activeLanes) noexcept;
+    void trackLoudness (double inputEnergy, double outputEnergy, size_t numSamples) noexcept;
+    SampleType getTableGain (DistortionModel model, SampleType drive) const noexcept;
+    
+    /*
+     With modulation every ramp is built at control rate: the smoothers are read at each
+     control point (they are linear, skip() is exact), the offsets added, the gains worked
+     out there and interpolated linearly in between. The control points use the scratch layout.
+     */
+    void prepareModulation (size_t numSamples, size_t activeLanes) noexcept;
+    void fillModulatedRamps (size_t lane, LaneRamps& ramp, size_t start, size_t count) noexcept;
+    bool fillModulatedRamp (size_t index, SampleType* values, size_t start, size_t count) noexcept;
+    SampleType* getControl (size_t index) const noexcept { return _control.get() + index * _maxControlValues; }
+    
+    static double getEnergy (const SampleType* samples, int numSamples) noexcept
+    {
+        auto energy = 0.0;
+        
+        for (int i = 0; i < numSamples; ++i)
+            energy += (double) samples[i] * (double) samples[i];
+        
+        return energy;
+    }
+  
+    ///Lane 1 is only read in dual mono and mid-side
+    size_t getNumActiveLanes (size_t numChannels) const noexcept
+    {
+        return _stereoMode == StereoMode::cLinked ? 1 : juce::jlimit ((size_t) 1, numLanes, numChannels);
+    }
+    
+    //Scratch layout, maxBlockSize per entry: five ramps per lane, the output and blend ramps, then the two wet signals
+    static constexpr size_t scratchPreGain       = 0;
+    static constexpr size_t scratchPostGain      = 1;
+    static constexpr size_t scratchMix           = 2;
+    static constexpr size_t scratchBlendPreGain  = 3;
+    static constexpr size_t scratchBlendPostGain = 4;
+    static constexpr size_t scratchPerLane       = 5;
+    static constexpr size_t scratchOutput        = numLanes * scratchPerLane;
+    static constexpr size_t scratchBlend         = scratchOutput + 1;
+    static constexpr size_t scratchWet           = scratchBlend + 1;
+    static constexpr size_t scratchBlendWet      = scratchWet + 1;
+    static constexpr size_t scratchSize          = scratchBlendWet + 1;
+    
+    //Control points cover the ramps only
+    static constexpr size_t controlSize = scratchBlend + 1;
+    
+    SampleType* getScratch (size_t index) const noexcept { return _scratch.get() + index * _maxBlockSize; }
+    
+  //Used smoothed values to avoid audio glitches, drive and mix live in the lanes
+    struct Lane
+    {
+        DistortionModel model = DistortionModel::cHard;
+        juce::SmoothedValue<SampleType> input;
+        juce::SmoothedValue<SampleType> mix;
+    };
+    
+    struct LaneRamps
+    {
+        SampleType* preGains = nullptr;
+        SampleType* postGains = nullptr;
+        SampleType* mixValues = nullptr;
+        SampleType* blendPreGains = nullptr;
+        SampleType* blendPostGains = nullptr;
+        bool driveRamping = false;
+        bool mixRamping = false;
+        bool blending = false;
+    };
+    
+    std::array<Lane, numLanes> _lanes;
+  //Output as a linear gain, a multiplicative ramp is a straight line in dB with no pow per sample
+    juce::SmoothedValue<SampleType, juce::ValueSmoothingTypes::Multiplicative> _output;
+    DistortionModel _blendModel = DistortionModel::cHard;
+    juce::SmoothedValue<SampleType> _blend;
+    StereoMode _stereoMode = StereoMode::cLinked;
+    
+  //DC blocker on the wet signal, input and output per channel
+    static constexpr SampleType dcCutoff = SampleType (10);
+    AlignedBuffer<SampleType> _dcState;
+    SampleType _dcPole = SampleType (1);
+    
+  //For Soft Clipping
+    static constexpr SampleType piDi = SampleType (2) / juce::MathConstants<SampleType>::pi;
+    
+  //Auto gain table, 0 - 24 dB drive in half dB steps for every model, measured by running the models on a sine at prepare()
+    static constexpr int numModels = 9;
+    static constexpr int autoGainSteps = 49;
+    static constexpr SampleType autoGainStepDb = SampleType (0.5);
+    
+    struct AutoGainTable
+    {
+        std::array<std::array<SampleType, autoGainSteps>, numModels> gains {};
+        
+        size_t getMemoryFootprintBytes() const noexcept { return sizeof (*this); }
+    };
+    
+    juce::SharedResourcePointer<SharedResourceCache> _sharedResources;
+    std::shared_ptr<const AutoGainTable> _autoGainTable;
+    
+  //Auto gain state, the output parameter is kept apart from the compensation added to it
+    bool _autoGain = false;
+    SampleType _userOutput = SampleType (0);
+    SampleType _autoGainDb = SampleType (0);
+    SampleType _tableGain = SampleType (1);
+    SampleType _residualDb = SampleType (0);
+    double _inputPower = 0.0;
+    double _outputPower = 0.0;
+    
+  //Ceiling of the hard clip stages
+    static constexpr SampleType clipLevel = SampleType (0.99);
+    bool _safetyClip = true;
+    
+  //Sample Rate
+    float _sampleRate = 48000.0f;
+  
+  //Circuit model, keeps a state per channel
+    DiodeClipper<SampleType> _diodeClipper;
+    
+  //Tape model, magnetisation per channel
+    TapeHysteresis<SampleType> _tape;
+    
+  //Wavefolder and triode, the last input per channel for the ADAA
+    BiasedShaper<SampleType> _folder;
+    BiasedShaper<SampleType> _triode;
+    
+  //Harmonic designer, stateless apart from the design, so every stage shares it
+    ChebyshevShaper<SampleType> _harmonics;
+    
+  //Cascade stages after the first, with their own circuit and tape state
+    struct Stage
+    {
+        DistortionModel model = DistortionModel::cHard;
+        juce::SmoothedValue<SampleType> drive;
+        SampleType tone = SampleType (8000);
+        DiodeClipper<SampleType> diodeClipper;
+        TapeHysteresis<SampleType> tape;
+        BiasedShaper<SampleType> folder;
+        BiasedShaper<SampleType> triode;
+    };
+    
+  //Per piece: gains ramp linearly from the smoother at the start of the piece to the one at its end
+    struct StageRamp
+    {
+        SampleType preGain = SampleType (1);
+        SampleType preStep = SampleType (0);
+        SampleType postGain = SampleType (1);
+        SampleType postStep = SampleType (0);
+        SampleType highPass = SampleType (1);
+        SampleType lowPass = SampleType (1);
+    };
+    
+    std::array<Stage, maxStages - 1> _stages;
+    std::array<StageRamp, maxStages - 1> _stageRamps;
+    int _numStages = 1;
+    int _requestedStages = 1;
+    
+  //Coupling high-pass in, out and tone low-pass out, per stage and channel
+    AlignedBuffer<SampleType> _stageFilters;
+    static constexpr size_t stageFilterSize = 3;
+    SampleType* getStageFilter (size_t stage, int channel) const noexcept { return _stageFilters.get() + (stage * _numChannels + (size_t) channel) * stageFilterSize; }
+    
+  //Coupling capacitor between the stages, keeps the dc of an asymmetric stage out of the next one
+    static constexpr SampleType couplingCutoff = SampleType (20);
+    
+  //Neural capture, one hidden state per channel and a float copy of the wet signal for double processing
+    const NeuralNetworkBase* _network = nullptr;
+    AlignedBuffer<float> _neuralState;
+    AlignedBuffer<float> _neuralBuffer;
+    
+  //Timeline, only read when recording
+    TraceRecorder* _trace = nullptr;
+    
+  //Modulation of the current block and its control points
+    ModulationMatrix::Block _modulation;
+    bool _modulated = false;
+    size_t _modulatedSamples = 0;
+    size_t _controlInterval = 1;
+    AlignedBuffer<SampleType> _control;
+    size_t _maxControlValues = 0;
+    
+  //Ramps and the wet signal, see the scratch layout above
+    AlignedBuffer<SampleType> _scratch;
+    size_t _maxBlockSize = 0;
+    size_t _numChannels = 0;
+};
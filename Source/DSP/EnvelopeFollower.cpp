@@ -0,0 +1,69 @@
+/*
+  ==============================================================================
+
+    EnvelopeFollower.cpp
+    Created: 19 Oct 2026 9:02:41pm
+    Author:  Alperen Kurbetci
+
+  ==============================================================================
+*/
+
+#include "EnvelopeFollower.h"
+
+EnvelopeFollower::EnvelopeFollower()
+{
+
+}
+
+void EnvelopeFollower::prepare (double sampleRate, int maxBlockSize, int controlInterval)
+{
+    _controlInterval = juce::jmax (1, controlInterval);
+
+    //Coefficients per frame, a shorter last frame uses them too
+    const auto frameRate = sampleRate / _controlInterval;
+    _attackCoefficient  = static_cast<float> (1.0 - std::exp (-1.0 / (attackSeconds * frameRate)));
+    _releaseCoefficient = static_cast<float> (1.0 - std::exp (-1.0 / (releaseSeconds * frameRate)));
+
+    _values.allocate ((size_t) getNumValues (maxBlockSize, _controlInterval), true);
+
+    reset();
+}
+
+void EnvelopeFollower::reset()
+{
+    _level = 0.0f;
+    _values.clear();
+}
+
+float EnvelopeFollower::toControlValue (float level) noexcept
+{
+    const auto decibels = juce::Decibels::gainToDecibels (level, floorDecibels);
+    return juce::jmap (juce::jlimit (floorDecibels, 0.0f, decibels), floorDecibels, 0.0f, 0.0f, 1.0f);
+}
+
+const float* EnvelopeFollower::process (const float* const* channels, int numChannels, int numSamples) noexcept
+{
+    jassert (getNumValues (numSamples, _controlInterval) <= (int) _values.size());
+
+    //Where the last block ended
+    _values[0] = toControlValue (_level);
+
+    auto frame = 1;
+
+    for (int start = 0; start < numSamples; start += _controlInterval, ++frame)
+    {
+        const auto count = juce::jmin (_controlInterval, numSamples - start);
+        auto peak = 0.0f;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const auto range = juce::FloatVectorOperations::findMinAndMax (channels[channel] + start, count);
+            peak = juce::jmax (peak, -range.getStart(), range.getEnd());
+        }
+
+        _level += (peak - _level) * (peak > _level ? _attackCoefficient : _releaseCoefficient);
+        _values[(size_t) frame] = toControlValue (_level);
+    }
+
+    return _values.get();
+}
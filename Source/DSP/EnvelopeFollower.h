@@ -0,0 +1,58 @@
+/*
+  ==============================================================================
+
+    EnvelopeFollower.h
+    Created: 19 Oct 2026 9:02:41pm
+    Author:  Alperen Kurbetci
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "AlignedBuffer.h"
+
+/*
+ Envelope of a signal at control rate, one value every control interval.
+
+ Each frame takes the peak of all channels (a vector min / max pass), the follower and the
+ dB mapping then run once per frame, so the cost per sample is only the peak search.
+ The result goes from 0 (below floorDecibels) to 1 (0 dBFS).
+ */
+class EnvelopeFollower
+
+{
+public:
+
+    EnvelopeFollower();
+
+    void prepare (double sampleRate, int maxBlockSize, int controlInterval);
+
+    void reset();
+
+    ///Number of control values for a block: one per frame plus where the last block ended
+    static int getNumValues (int numSamples, int controlInterval) noexcept { return (numSamples + controlInterval - 1) / controlInterval + 1; }
+
+    /*
+     Value k is the envelope at sample k * controlInterval of the block (the last one at the block end),
+     value 0 is where the previous block ended.
+     */
+    const float* process (const float* const* channels, int numChannels, int numSamples) noexcept;
+
+    size_t getMemoryFootprintBytes() const noexcept { return sizeof (*this) + _values.getSizeInBytes(); }
+
+private:
+
+    static float toControlValue (float level) noexcept;
+
+    static constexpr double attackSeconds = 0.005;
+    static constexpr double releaseSeconds = 0.15;
+    static constexpr float floorDecibels = -48.0f;
+
+    int _controlInterval = 32;
+    float _attackCoefficient = 0.0f;
+    float _releaseCoefficient = 0.0f;
+    float _level = 0.0f;
+
+    AlignedBuffer<float> _values;
+};
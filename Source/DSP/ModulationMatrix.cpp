@@ -0,0 +1,173 @@
+/*
+  ==============================================================================
+
+    ModulationMatrix.cpp
+    Created: 19 Oct 2026 10:14:07pm
+    Author:  Alperen Kurbetci
+
+  ==============================================================================
+*/
+
+#include "ModulationMatrix.h"
+
+ModulationMatrix::ModulationMatrix()
+{
+
+}
+
+void ModulationMatrix::prepare (double sampleRate, int maxBlockSize, int controlInterval)
+{
+    _sampleRate = sampleRate;
+    _controlInterval = juce::jlimit (minControlInterval, maxControlInterval, controlInterval);
+    _maxValues = (size_t) EnvelopeFollower::getNumValues (maxBlockSize, _controlInterval);
+
+    _inputEnvelope.prepare (sampleRate, maxBlockSize, _controlInterval);
+    _sidechainEnvelope.prepare (sampleRate, maxBlockSize, _controlInterval);
+
+    _lfoValues.allocate ((size_t) numLfos * _maxValues, true);
+    _offsets.allocate ((size_t) numDestinations * _maxValues, true);
+
+    for (int i = 0; i < numLfos; ++i)
+        _lfos[(size_t) i].increment = _lfoRates[(size_t) i] / _sampleRate;
+
+    reset();
+}
+
+void ModulationMatrix::reset()
+{
+    _inputEnvelope.reset();
+    _sidechainEnvelope.reset();
+
+    for (auto& lfo : _lfos)
+    {
+        lfo.phase = 0.0;
+        lfo.held = 0.0f;
+    }
+}
+
+void ModulationMatrix::setSlot (int index, Source source, Destination destination, float amount) noexcept
+{
+    jassert (juce::isPositiveAndBelow (index, maxSlots));
+
+    auto& slot = _slots[(size_t) index];
+    slot.source = source;
+    slot.destination = destination;
+    slot.amount = amount;
+}
+
+void ModulationMatrix::setLfo (int index, float rateHz, LfoShape shape) noexcept
+{
+    jassert (juce::isPositiveAndBelow (index, numLfos));
+
+    _lfoRates[(size_t) index] = rateHz;
+    _lfos[(size_t) index].shape = shape;
+    _lfos[(size_t) index].increment = rateHz / _sampleRate;
+}
+
+float ModulationMatrix::getLfoValue (const Lfo& lfo) noexcept
+{
+    const auto phase = (float) lfo.phase;
+
+    switch (lfo.shape)
+    {
+        case LfoShape::cSine:      return std::sin (juce::MathConstants<float>::twoPi * phase);
+        case LfoShape::cTriangle:  return 1.0f - 4.0f * std::abs (phase - 0.5f);
+        case LfoShape::cSaw:       return 2.0f * phase - 1.0f;
+        case LfoShape::cSquare:    return phase < 0.5f ? 1.0f : -1.0f;
+        case LfoShape::cRandom:    return lfo.held;
+    }
+
+    return 0.0f;
+}
+
+void ModulationMatrix::processLfo (Lfo& lfo, float* values, int numSamples, int numValues) noexcept
+{
+    auto position = 0;
+
+    for (int k = 0; k < numValues; ++k)
+    {
+        const auto next = juce::jmin (k * _controlInterval, numSamples);
+        lfo.phase += lfo.increment * (next - position);
+        position = next;
+
+        //The random shape picks a new value every cycle and holds it
+        if (lfo.phase >= 1.0)
+        {
+            lfo.phase -= std::floor (lfo.phase);
+            lfo.held = _random.nextFloat() * 2.0f - 1.0f;
+        }
+
+        values[k] = getLfoValue (lfo);
+    }
+}
+
+ModulationMatrix::Block ModulationMatrix::process (const float* const* input, int numInputChannels,
+                                                   const float* const* sidechain, int numSidechainChannels, int numSamples) noexcept
+{
+    Block block;
+    const auto numValues = EnvelopeFollower::getNumValues (numSamples, _controlInterval);
+
+    if (numSamples <= 0 || (size_t) numValues > _maxValues)
+        return block;
+
+    //One copy of the routing for the whole block, a slot changed meanwhile is picked up next time
+    const auto slots = _slots;
+
+    bool sourceUsed[numSources] = {};
+    bool destinationUsed[numDestinations] = {};
+
+    for (const auto& slot : slots)
+    {
+        if (! slot.isActive())
+            continue;
+
+        sourceUsed[(int) slot.source] = true;
+        destinationUsed[(int) slot.destination] = true;
+    }
+
+    //Unused sources are not run at all, the envelopes pick up again from where they were
+    const float* sources[numSources] = {};
+
+    for (int i = 0; i < numLfos; ++i)
+    {
+        if (! sourceUsed[(int) Source::cLfo1 + i])
+            continue;
+
+        auto* values = _lfoValues.get() + (size_t) i * _maxValues;
+        processLfo (_lfos[(size_t) i], values, numSamples, numValues);
+        sources[(int) Source::cLfo1 + i] = values;
+    }
+
+    if (sourceUsed[(int) Source::cEnvelope])
+        sources[(int) Source::cEnvelope] = _inputEnvelope.process (input, numInputChannels, numSamples);
+
+    //A disconnected sidechain reads as silence, so the envelope falls back to zero
+    if (sourceUsed[(int) Source::cSidechain])
+        sources[(int) Source::cSidechain] = _sidechainEnvelope.process (sidechain, numSidechainChannels, numSamples);
+
+    auto active = false;
+
+    for (int destination = 0; destination < numDestinations; ++destination)
+    {
+        if (! destinationUsed[destination])
+            continue;
+
+        auto* offsets = _offsets.get() + (size_t) destination * _maxValues;
+        juce::FloatVectorOperations::clear (offsets, numValues);
+
+        for (const auto& slot : slots)
+            if (slot.isActive() && (int) slot.destination == destination)
+                juce::FloatVectorOperations::addWithMultiply (offsets, sources[(int) slot.source], slot.amount, numValues);
+
+        block.offsets[destination] = offsets;
+        active = true;
+    }
+
+    if (active)
+    {
+        block.numSamples = (size_t) numSamples;
+        block.controlInterval = _controlInterval;
+    }
+
+    return block;
+}
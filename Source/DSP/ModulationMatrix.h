@@ -0,0 +1,136 @@
+/*
+  ==============================================================================
+
+    ModulationMatrix.h
+    Created: 19 Oct 2026 10:14:07pm
+    Author:  Alperen Kurbetci
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "EnvelopeFollower.h"
+
+/*
+ Internal modulation, evaluated at control rate instead of through host automation.
+
+ Sources are two LFOs, the envelope of the main input and the envelope of the sidechain.
+ A fixed array of slots routes them to the destinations, each slot adds source * amount
+ (amount in the destination's unit: dB for drive and output, 0 - 1 for mix and blend).
+ Everything is sized in prepare(), process() does not allocate and skips every source
+ and destination no slot uses.
+ */
+class ModulationMatrix
+
+{
+public:
+
+    enum class Source
+    {
+        cOff,
+        cLfo1,
+        cLfo2,
+        cEnvelope,
+        cSidechain
+    };
+
+    enum class Destination
+    {
+        cDrive,
+        cMix,
+        cOutput,
+        cBlend
+    };
+
+    enum class LfoShape
+    {
+        cSine,
+        cTriangle,
+        cSaw,
+        cSquare,
+        cRandom
+    };
+
+    static constexpr int numSources = 5;
+    static constexpr int numDestinations = 4;
+    static constexpr int numLfos = 2;
+    static constexpr int maxSlots = 8;
+
+    static constexpr int minControlInterval = 8;
+    static constexpr int maxControlInterval = 64;
+
+    /*
+     What one process() call produced: per destination the offset at every control point
+     (see EnvelopeFollower), nullptr when nothing modulates it. Valid until the next call.
+     */
+    struct Block
+    {
+        const float* offsets[numDestinations] {};
+        size_t numSamples = 0;
+        int controlInterval = 0;
+
+        bool isActive() const noexcept { return controlInterval > 0; }
+    };
+
+    ModulationMatrix();
+
+    void prepare (double sampleRate, int maxBlockSize, int controlInterval);
+
+    void reset();
+
+    void setSlot (int index, Source source, Destination destination, float amount) noexcept;
+    void setLfo (int index, float rateHz, LfoShape shape) noexcept;
+
+    int getControlInterval() const noexcept { return _controlInterval; }
+
+    size_t getMemoryFootprintBytes() const noexcept
+    {
+        return sizeof (*this) + _lfoValues.getSizeInBytes() + _offsets.getSizeInBytes()
+             + _inputEnvelope.getMemoryFootprintBytes() - sizeof (_inputEnvelope)
+             + _sidechainEnvelope.getMemoryFootprintBytes() - sizeof (_sidechainEnvelope);
+    }
+
+    ///Reads the sources for the next numSamples, the envelopes from the dry input and the sidechain (which may have no channels)
+    Block process (const float* const* input, int numInputChannels,
+                   const float* const* sidechain, int numSidechainChannels, int numSamples) noexcept;
+
+private:
+
+    struct Slot
+    {
+        Source source = Source::cOff;
+        Destination destination = Destination::cDrive;
+        float amount = 0.0f;
+
+        bool isActive() const noexcept { return source != Source::cOff && amount != 0.0f; }
+    };
+
+    struct Lfo
+    {
+        LfoShape shape = LfoShape::cSine;
+        double increment = 0.0;
+        double phase = 0.0;
+        float held = 0.0f;
+    };
+
+    ///Bipolar LFO values at the control points, the phase ends where the block does
+    void processLfo (Lfo& lfo, float* values, int numSamples, int numValues) noexcept;
+    static float getLfoValue (const Lfo& lfo) noexcept;
+
+    std::array<Slot, maxSlots> _slots;
+    std::array<Lfo, numLfos> _lfos;
+    std::array<float, numLfos> _lfoRates {};
+
+    EnvelopeFollower _inputEnvelope;
+    EnvelopeFollower _sidechainEnvelope;
+
+    double _sampleRate = 48000.0;
+    int _controlInterval = 32;
+    size_t _maxValues = 0;
+    juce::Random _random;
+
+    //Control points per LFO and per destination, _maxValues each
+    AlignedBuffer<float> _lfoValues;
+    AlignedBuffer<float> _offsets;
+};
@@ -0,0 +1,289 @@
+/*
+  ==============================================================================
+
+    NeuralNetwork.cpp
+    Created: 19 Oct 2026 10:14:40am
+    Author:  Alperen Kurbetci
+
+  ==============================================================================
+*/
+
+#include "NeuralNetwork.h"
+
+namespace
+{
+    //Sections of the arena are rounded up to 16 floats (64 bytes) so each one starts aligned
+    constexpr size_t padToLine (size_t numFloats) { return (numFloats + 15) & ~(size_t) 15; }
+
+    void flattenInto (const juce::var& value, std::vector<float>& destination)
+    {
+        if (auto* array = value.getArray())
+        {
+            for (auto& element : *array)
+                flattenInto (element, destination);
+        }
+        else if (value.isDouble() || value.isInt() || value.isInt64())
+        {
+            destination.push_back (static_cast<float> (static_cast<double> (value)));
+        }
+    }
+
+    std::vector<float> readArray (const juce::var& object, const char* name)
+    {
+        std::vector<float> values;
+        flattenInto (object.getProperty (name, {}), values);
+        return values;
+    }
+
+    template <bool IsLSTM>
+    std::unique_ptr<NeuralNetworkBase> createRecurrent (int hiddenSize,
+                                                        const std::vector<float>& weightIH, const std::vector<float>& weightHH,
+                                                        const std::vector<float>& biasIH,   const std::vector<float>& biasHH,
+                                                        const std::vector<float>& denseWeight, float denseBias, bool useSkip)
+    {
+        switch (hiddenSize)
+        {
+            case 8:  return std::make_unique<RecurrentNetwork<IsLSTM, 8>>  (weightIH, weightHH, biasIH, biasHH, denseWeight, denseBias, useSkip);
+            case 16: return std::make_unique<RecurrentNetwork<IsLSTM, 16>> (weightIH, weightHH, biasIH, biasHH, denseWeight, denseBias, useSkip);
+            case 24: return std::make_unique<RecurrentNetwork<IsLSTM, 24>> (weightIH, weightHH, biasIH, biasHH, denseWeight, denseBias, useSkip);
+            case 32: return std::make_unique<RecurrentNetwork<IsLSTM, 32>> (weightIH, weightHH, biasIH, biasHH, denseWeight, denseBias, useSkip);
+            default: return nullptr;
+        }
+    }
+}
+
+//==============================================================================
+std::unique_ptr<NeuralNetworkBase> NeuralNetworkBase::createFromFile (const juce::File& file, juce::String& errorMessage)
+{
+    if (! file.existsAsFile())
+    {
+        errorMessage = "Model file not found: " + file.getFullPathName();
+        return nullptr;
+    }
+
+    juce::var json;
+    auto result = juce::JSON::parse (file.loadFileAsString(), json);
+
+    if (result.failed())
+    {
+        errorMessage = result.getErrorMessage();
+        return nullptr;
+    }
+
+    return createFromJSON (json, errorMessage);
+}
+
+std::unique_ptr<SharedNeuralNetwork> SharedNeuralNetwork::createFromFile (const juce::File& file, juce::String& errorMessage)
+{
+    juce::SharedResourcePointer<SharedResourceCache> cache;
+
+    auto network = cache->getOrBuild<NeuralNetworkBase> ("Neural model/" + SharedResourceCache::getFileKey (file), [&file, &errorMessage]
+    {
+        return std::shared_ptr<const NeuralNetworkBase> (NeuralNetworkBase::createFromFile (file, errorMessage));
+    });
+
+    if (network == nullptr)
+        return nullptr;
+
+    return std::make_unique<SharedNeuralNetwork> (std::move (network));
+}
+
+std::unique_ptr<NeuralNetworkBase> NeuralNetworkBase::createFromJSON (const juce::var& json, juce::String& errorMessage)
+{
+    const auto type       = json.getProperty ("type", {}).toString().toLowerCase();
+    const int hiddenSize  = json.getProperty ("hidden_size", 0);
+    const bool useSkip    = json.getProperty ("skip", false);
+
+    if (type != "gru" && type != "lstm")
+    {
+        errorMessage = "Unsupported model type: " + type;
+        return nullptr;
+    }
+
+    if (hiddenSize != 8 && hiddenSize != 16 && hiddenSize != 24 && hiddenSize != 32)
+    {
+        errorMessage = "Unsupported hidden size: " + juce::String (hiddenSize);
+        return nullptr;
+    }
+
+    const auto rec   = json.getProperty ("rec", {});
+    const auto dense = json.getProperty ("dense", {});
+
+    auto weightIH    = readArray (rec, "weight_ih");
+    auto weightHH    = readArray (rec, "weight_hh");
+    auto biasIH      = readArray (rec, "bias_ih");
+    auto biasHH      = readArray (rec, "bias_hh");
+    auto denseWeight = readArray (dense, "weight");
+    auto denseBias   = readArray (dense, "bias");
+
+    const bool isLSTM   = type == "lstm";
+    const auto gateSize = (size_t) ((isLSTM ? 4 : 3) * hiddenSize);
+
+    if (weightIH.size() != gateSize || weightHH.size() != gateSize * (size_t) hiddenSize
+        || biasIH.size() != gateSize || biasHH.size() != gateSize
+        || denseWeight.size() != (size_t) hiddenSize || denseBias.size() != 1)
+    {
+        errorMessage = "Weight shapes do not match a single input " + type + " with " + juce::String (hiddenSize) + " units";
+        return nullptr;
+    }
+
+    if (isLSTM)
+        return createRecurrent<true>  (hiddenSize, weightIH, weightHH, biasIH, biasHH, denseWeight, denseBias[0], useSkip);
+
+    return createRecurrent<false> (hiddenSize, weightIH, weightHH, biasIH, biasHH, denseWeight, denseBias[0], useSkip);
+}
+
+//==============================================================================
+template <bool IsLSTM, int HiddenSize>
+
+RecurrentNetwork<IsLSTM, HiddenSize>::RecurrentNetwork (const std::vector<float>& weightIH, const std::vector<float>& weightHH,
+                                                        const std::vector<float>& biasIH,   const std::vector<float>& biasHH,
+                                                        const std::vector<float>& denseWeight, float denseBias, bool useSkip)
+    : _denseBias (denseBias), _useSkip (useSkip)
+{
+    const auto weightIHSize = padToLine (gateSize);
+    const auto weightHHSize = padToLine ((size_t) gateSize * HiddenSize);
+    const auto biasXSize    = padToLine (gateSize);
+    const auto biasHNSize   = padToLine (HiddenSize);
+    const auto denseSize    = padToLine (HiddenSize);
+
+    _arena.allocate (weightIHSize + weightHHSize + biasXSize + biasHNSize + denseSize, true);
+
+    auto* weightIHData  = _arena.get();
+    auto* weightHHTData = weightIHData  + weightIHSize;
+    auto* biasXData     = weightHHTData + weightHHSize;
+    auto* biasHNData    = biasXData     + biasXSize;
+    auto* denseData     = biasHNData    + biasHNSize;
+
+    std::copy (weightIH.begin(), weightIH.end(), weightIHData);
+    std::copy (denseWeight.begin(), denseWeight.end(), denseData);
+
+    //Stored column major so one step is HiddenSize broadcasts times whole gate columns
+    for (int row = 0; row < gateSize; ++row)
+        for (int column = 0; column < HiddenSize; ++column)
+            weightHHTData[column * gateSize + row] = weightHH[(size_t) (row * HiddenSize + column)];
+
+    //The recurrent bias can be folded into the input bias everywhere but in the GRU n gate,
+    //which is scaled by the reset gate
+    for (int i = 0; i < gateSize; ++i)
+    {
+        const bool isCandidateGate = ! IsLSTM && i >= 2 * HiddenSize;
+        biasXData[i] = biasIH[(size_t) i] + (isCandidateGate ? 0.0f : biasHH[(size_t) i]);
+    }
+
+    if (! IsLSTM)
+        for (int i = 0; i < HiddenSize; ++i)
+            biasHNData[i] = biasHH[(size_t) (2 * HiddenSize + i)];
+
+    _weightIH  = weightIHData;
+    _weightHHT = weightHHTData;
+    _biasX     = biasXData;
+    _biasHN    = biasHNData;
+    _denseW    = denseData;
+}
+
+template <bool IsLSTM, int HiddenSize>
+
+void RecurrentNetwork<IsLSTM, HiddenSize>::multiplyRecurrent (const float* hidden, float* result) const noexcept
+{
+   #if JUCE_USE_SIMD
+    using Vec = juce::dsp::SIMDRegister<float>;
+    constexpr int lanes = (int) Vec::SIMDNumElements;
+
+    if constexpr (gateSize % lanes == 0)
+    {
+        constexpr int numVecs = gateSize / lanes;
+        Vec accumulators[numVecs];
+
+        for (auto& accumulator : accumulators)
+            accumulator = Vec::expand (0.0f);
+
+        for (int column = 0; column < HiddenSize; ++column)
+        {
+            const auto h = Vec::expand (hidden[column]);
+            const auto* weights = _weightHHT + column * gateSize;
+
+            for (int v = 0; v < numVecs; ++v)
+                accumulators[v] = Vec::multiplyAdd (accumulators[v], Vec::fromRawArray (weights + v * lanes), h);
+        }
+
+        for (int v = 0; v < numVecs; ++v)
+            accumulators[v].copyToRawArray (result + v * lanes);
+
+        return;
+    }
+   #endif
+
+    std::fill (result, result + gateSize, 0.0f);
+
+    for (int column = 0; column < HiddenSize; ++column)
+    {
+        const auto h = hidden[column];
+        const auto* weights = _weightHHT + column * gateSize;
+
+        for (int row = 0; row < gateSize; ++row)
+            result[row] += weights[row] * h;
+    }
+}
+
+template <bool IsLSTM, int HiddenSize>
+
+void RecurrentNetwork<IsLSTM, HiddenSize>::process (float* state, const float* input, float* output, int numSamples) const noexcept
+{
+    using namespace NeuralActivations;
+
+    auto* hidden = state;
+    auto* cell   = state + HiddenSize;
+
+    alignas (64) float recurrent[gateSize];
+
+    for (int n = 0; n < numSamples; ++n)
+    {
+        const auto x = input[n];
+
+        multiplyRecurrent (hidden, recurrent);
+
+        if constexpr (IsLSTM)
+        {
+            for (int k = 0; k < HiddenSize; ++k)
+            {
+                const auto i = sigmoid (_weightIH[k]                  * x + _biasX[k]                  + recurrent[k]);
+                const auto f = sigmoid (_weightIH[k + HiddenSize]     * x + _biasX[k + HiddenSize]     + recurrent[k + HiddenSize]);
+                const auto g = tanh    (_weightIH[k + 2 * HiddenSize] * x + _biasX[k + 2 * HiddenSize] + recurrent[k + 2 * HiddenSize]);
+                const auto o = sigmoid (_weightIH[k + 3 * HiddenSize] * x + _biasX[k + 3 * HiddenSize] + recurrent[k + 3 * HiddenSize]);
+
+                cell[k]   = f * cell[k] + i * g;
+                hidden[k] = o * tanh (cell[k]);
+            }
+        }
+        else
+        {
+            for (int k = 0; k < HiddenSize; ++k)
+            {
+                const auto r  = sigmoid (_weightIH[k]              * x + _biasX[k]              + recurrent[k]);
+                const auto z  = sigmoid (_weightIH[k + HiddenSize] * x + _biasX[k + HiddenSize] + recurrent[k + HiddenSize]);
+                const auto nc = tanh    (_weightIH[k + 2 * HiddenSize] * x + _biasX[k + 2 * HiddenSize]
+                                         + r * (recurrent[k + 2 * HiddenSize] + _biasHN[k]));
+
+                hidden[k] = (1.0f - z) * nc + z * hidden[k];
+            }
+        }
+
+        auto y = _denseBias;
+
+        for (int k = 0; k < HiddenSize; ++k)
+            y += _denseW[k] * hidden[k];
+
+        output[n] = _useSkip ? y + x : y;
+    }
+}
+
+//Every supported shape is compiled here, the factory above picks one at load time
+template class RecurrentNetwork<false, 8>;
+template class RecurrentNetwork<false, 16>;
+template class RecurrentNetwork<false, 24>;
+template class RecurrentNetwork<false, 32>;
+template class RecurrentNetwork<true, 8>;
+template class RecurrentNetwork<true, 16>;
+template class RecurrentNetwork<true, 24>;
+template class RecurrentNetwork<true, 32>;
@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    NeuralNetwork.h
+    Created: 19 Oct 2026 10:14:40am
+    Author:  Alperen Kurbetci
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "AlignedBuffer.h"
+#include "SharedResourceCache.h"
+
+/*
+ Real-time inference for small recurrent amp/pedal captures (one recurrent layer + dense output).
+
+ The network is immutable once built, all the per-channel memory (hidden and cell states) lives in a
+ state buffer owned by the caller, so one network can be shared by any number of channels/instances.
+
+ Model file (JSON), weights follow the PyTorch layout (gate order r,z,n for GRU and i,f,g,o for LSTM):
+ {
+   "type": "gru" or "lstm",
+   "hidden_size": 8, 16, 24 or 32,
+   "skip": true,                       //optional, adds the input to the output
+   "rec":   { "weight_ih": [...], "weight_hh": [...], "bias_ih": [...], "bias_hh": [...] },
+   "dense": { "weight": [...], "bias": [...] }
+ }
+ Nested arrays are flattened in row-major order.
+ */
+class NeuralNetworkBase
+
+{
+public:
+
+    virtual ~NeuralNetworkBase() = default;
+
+    ///Number of floats the caller must reserve per channel (16 byte aligned)
+    virtual int getStateSize() const noexcept = 0;
+
+    ///Runs the network over a block, the state is updated in place
+    virtual void process (float* state, const float* input, float* output, int numSamples) const noexcept = 0;
+
+    virtual size_t getMemoryFootprintBytes() const noexcept = 0;
+
+    //Largest state any model can ask for (LSTM, 32 units: hidden + cell)
+    static constexpr int maxStateSize = 64;
+
+    //Parses a model file. Returns nullptr and fills errorMessage when the file is not a valid model
+    static std::unique_ptr<NeuralNetworkBase> createFromJSON (const juce::var& json, juce::String& errorMessage);
+    static std::unique_ptr<NeuralNetworkBase> createFromFile (const juce::File& file, juce::String& errorMessage);
+};
+
+/*
+ What the model loader swaps in: a handle on a network that other instances may be running too.
+ Every instance that loads the same file gets the same weights, parsed once for the process.
+ */
+class SharedNeuralNetwork
+
+{
+public:
+
+    explicit SharedNeuralNetwork (std::shared_ptr<const NeuralNetworkBase> network) : _network (std::move (network)) {}
+
+    const NeuralNetworkBase* get() const noexcept { return _network.get(); }
+
+    static std::unique_ptr<SharedNeuralNetwork> createFromFile (const juce::File& file, juce::String& errorMessage);
+
+private:
+
+    std::shared_ptr<const NeuralNetworkBase> _network;
+};
+
+//Gate activations, kept cheap and bounded so the Pade approximation never leaves its valid range
+namespace NeuralActivations
+{
+    inline float tanh (float x) noexcept
+    {
+        return juce::dsp::FastMathApproximations::tanh (juce::jlimit (-5.0f, 5.0f, x));
+    }
+
+    inline float sigmoid (float x) noexcept
+    {
+        return 0.5f * tanh (0.5f * x) + 0.5f;
+    }
+}
+
+/*
+ One recurrent layer specialised at compile time on the cell type and hidden size,
+ so every loop below has a constant trip count and the gate vectors are whole SIMD registers.
+ */
+template <bool IsLSTM, int HiddenSize>
+
+class RecurrentNetwork : public NeuralNetworkBase
+
+{
+public:
+
+    static_assert (HiddenSize % 4 == 0, "Hidden size must fill whole SIMD registers");
+
+    static constexpr int numGates = IsLSTM ? 4 : 3;
+    static constexpr int gateSize = numGates * HiddenSize;
+
+    RecurrentNetwork (const std::vector<float>& weightIH, const std::vector<float>& weightHH,
+                      const std::vector<float>& biasIH,   const std::vector<float>& biasHH,
+                      const std::vector<float>& denseWeight, float denseBias, bool useSkip);
+
+    int getStateSize() const noexcept override { return IsLSTM ? 2 * HiddenSize : HiddenSize; }
+
+    void process (float* state, const float* input, float* output, int numSamples) const noexcept override;
+
+    size_t getMemoryFootprintBytes() const noexcept override { return sizeof (*this) + _arena.getSizeInBytes(); }
+
+private:
+
+    //result = weightHH * hidden, the only O(H^2) part of a step
+    void multiplyRecurrent (const float* hidden, float* result) const noexcept;
+
+    //All weights in one contiguous aligned block, each section padded to 64 bytes
+    AlignedBuffer<float> _arena;
+    const float* _weightIH   = nullptr;   //gateSize
+    const float* _weightHHT  = nullptr;   //HiddenSize columns of gateSize (column major)
+    const float* _biasX      = nullptr;   //gateSize, input side bias (plus recurrent bias except GRU n gate)
+    const float* _biasHN     = nullptr;   //HiddenSize, GRU only: recurrent bias of the n gate
+    const float* _denseW     = nullptr;   //HiddenSize
+
+    float _denseBias = 0.0f;
+    bool _useSkip = false;
+};
@@ -0,0 +1,405 @@
+/*
+  ==============================================================================
+
+    OversampledDistortion.cpp
+    Created: 19 Oct 2026 11:02:18pm
+    Author:  Alperen Kurbetci
+
+  ==============================================================================
+*/
+
+#include "OversampledDistortion.h"
+
+template <typename SampleType>
+
+OversampledDistortion<SampleType>::OversampledDistortion()
+{
+
+}
+
+template <typename SampleType>
+
+void OversampledDistortion<SampleType>::prepare(const juce::dsp::ProcessSpec& spec, size_t oversamplingOrder, FilterType filterType, bool maxQuality)
+{
+    jassert (oversamplingOrder <= maxOrder);
+
+    _numChannels = spec.numChannels;
+    _maxBlockSize = spec.maximumBlockSize;
+    _order = juce::jmin(oversamplingOrder, maxOrder);
+
+    //The harmonic designer may need more than the prepared order, the orders in between are never picked
+    const auto harmonicOrder = ChebyshevShaper<SampleType>::getOversamplingOrder(ChebyshevShaper<SampleType>::maxHarmonic);
+    _harmonicOrder = juce::jmin(juce::jmax(_order, harmonicOrder), maxOrder);
+
+    for (size_t order = 0; order < _paths.size(); ++order)
+    {
+        auto& path = _paths[order];
+        path.oversampling.reset();
+
+        if (order != 0 && order != _order && order != _harmonicOrder)
+        {
+            path.distortion.reset();
+            continue;
+        }
+
+        const auto factor = (size_t) 1 << order;
+
+        //Integer latency, so the padding below lines up exactly
+        if (order > 0)
+        {
+            path.oversampling = std::make_unique<juce::dsp::Oversampling<SampleType>>(_numChannels, order, filterType, maxQuality, true);
+            path.oversampling->initProcessing(_maxBlockSize);
+        }
+
+        auto pathSpec = spec;
+        pathSpec.sampleRate *= (double) factor;
+        pathSpec.maximumBlockSize *= (juce::uint32) factor;
+
+        if (path.distortion == nullptr)
+            path.distortion = std::make_unique<Distortion<SampleType>>();
+
+        path.distortion->prepare(pathSpec);
+        path.distortion->setTraceRecorder(_trace);
+    }
+
+    if constexpr (! std::is_same_v<SampleType, float>)
+        _conversion.setSize((int) _numChannels, (int) _maxBlockSize);
+
+    _incoming.setSize((int) _numChannels, (int) _maxBlockSize);
+    _warmUpLength = juce::roundToInt(spec.sampleRate * warmUpSeconds);
+
+    _activeOrder = _order;
+    setLatency(getOversamplingLatency());
+}
+
+template <typename SampleType>
+
+void OversampledDistortion<SampleType>::reset()
+{
+    for (size_t order = 0; order < _paths.size(); ++order)
+        resetPath(order);
+
+    _delay.clear();
+    _delayPositions = {};
+    _activeRing = 0;
+
+    //Nothing is playing, so the right path can start straight away
+    _incomingOrder = noOrder;
+
+    if (_paths[_activeOrder].distortion != nullptr)
+        _activeOrder = selectOrder();
+
+    _modulation = {};
+}
+
+template <typename SampleType>
+
+void OversampledDistortion<SampleType>::resetPath(size_t order) noexcept
+{
+    auto& path = _paths[order];
+
+    if (path.distortion != nullptr)
+        path.distortion->reset();
+
+    if (path.oversampling != nullptr)
+        path.oversampling->reset();
+}
+
+template <typename SampleType>
+
+void OversampledDistortion<SampleType>::startIncoming(size_t order) noexcept
+{
+    resetPath(order);
+
+    const auto ring = 1 - _activeRing;
+    std::fill_n(_delay.get() + ring * _numChannels * (size_t) _delayLength, _numChannels * (size_t) _delayLength, SampleType (0));
+    _delayPositions[ring] = 0;
+
+    //The pad has to fill with the new path's output before anything of it is heard
+    _incomingOrder = order;
+    _warmUpRemaining = _latency + _warmUpLength;
+    _fadePosition = 0;
+}
+
+template <typename SampleType>
+
+int OversampledDistortion<SampleType>::getPathLatency(size_t order) const noexcept
+{
+    const auto& oversampling = _paths[order].oversampling;
+    return oversampling != nullptr ? juce::roundToInt(oversampling->getLatencyInSamples()) : 0;
+}
+
+template <typename SampleType>
+
+int OversampledDistortion<SampleType>::getOversamplingLatency() const noexcept
+{
+    auto latency = 0;
+
+    for (size_t order = 0; order < _paths.size(); ++order)
+        latency = juce::jmax(latency, getPathLatency(order));
+
+    return latency;
+}
+
+template <typename SampleType>
+
+void OversampledDistortion<SampleType>::setLatency(int latencySamples)
+{
+    _latency = juce::jmax(latencySamples, getOversamplingLatency());
+    _delayLength = _latency + 1;
+    _delay.allocate(2 * _numChannels * (size_t) _delayLength, true);
+
+    reset();
+}
+
+template <typename SampleType>
+
+void OversampledDistortion<SampleType>::setNeuralNetwork(const NeuralNetworkBase* newNetwork) noexcept
+{
+    forEachDistortion([newNetwork] (auto& distortion) { distortion.setNeuralNetwork(newNetwork); });
+}
+
+template <typename SampleType>
+
+void OversampledDistortion<SampleType>::setTraceRecorder(TraceRecorder* recorder) noexcept
+{
+    _trace = recorder;
+
+    forEachDistortion([recorder] (auto& distortion) { distortion.setTraceRecorder(recorder); });
+}
+
+template <typename SampleType>
+
+size_t OversampledDistortion<SampleType>::getMemoryFootprintBytes() const noexcept
+{
+    auto bytes = sizeof (*this) + _delay.getSizeInBytes()
+               + (size_t) _conversion.getNumChannels() * (size_t) _conversion.getNumSamples() * sizeof (SampleType)
+               + (size_t) _incoming.getNumChannels() * (size_t) _incoming.getNumSamples() * sizeof (SampleType);
+    
+    for (size_t order = 0; order < _paths.size(); ++order)
+    {
+        if (_paths[order].distortion == nullptr)
+            continue;
+
+        bytes += _paths[order].distortion->getMemoryFootprintBytes();
+        
+        //Each stage keeps a buffer at its own rate, together just under twice the oversampled block
+        if (_paths[order].oversampling != nullptr)
+            bytes += 2 * _numChannels * _maxBlockSize * ((size_t) 1 << order) * sizeof (SampleType);
+    }
+    
+    return bytes;
+}
+
+template <typename SampleType>
+
+void OversampledDistortion<SampleType>::process(juce::dsp::AudioBlock<float>& block) noexcept
+{
+    jassert (block.getNumSamples() <= _maxBlockSize);
+
+    if constexpr (std::is_same_v<SampleType, float>)
+    {
+        processBlock(block);
+    }
+    else
+    {
+        const auto numChannels = juce::jmin(block.getNumChannels(), _numChannels);
+        const auto numSamples = juce::jmin(block.getNumSamples(), _maxBlockSize);
+
+        for (size_t channel = 0; channel < numChannels; ++channel)
+        {
+            const auto* source = block.getChannelPointer(channel);
+            auto* destination = _conversion.getWritePointer((int) channel);
+
+            for (size_t i = 0; i < numSamples; ++i)
+                destination[i] = static_cast<SampleType> (source[i]);
+        }
+
+        juce::dsp::AudioBlock<SampleType> converted (_conversion.getArrayOfWritePointers(), numChannels, numSamples);
+        processBlock(converted);
+
+        for (size_t channel = 0; channel < numChannels; ++channel)
+        {
+            const auto* source = _conversion.getReadPointer((int) channel);
+            auto* destination = block.getChannelPointer(channel);
+
+            for (size_t i = 0; i < numSamples; ++i)
+                destination[i] = static_cast<float> (source[i]);
+        }
+    }
+}
+
+template <typename SampleType>
+
+size_t OversampledDistortion<SampleType>::selectOrder() const noexcept
+{
+    //The playing path, the others' smoothers stand still
+    const auto& distortion = *_paths[_activeOrder].distortion;
+
+    if (_order == 0 || distortion.usesModel(Distortion<SampleType>::DistortionModel::cNeural))
+        return 0;
+
+    const auto blendModulated = _modulation.offsets[(int) ModulationMatrix::Destination::cBlend] != nullptr;
+    const auto needed = distortion.getOversamplingOrder(_order, blendModulated);
+
+    //Only the built paths: a chain that needs less than the prepared order gets it anyway
+    if (needed == 0)
+        return 0;
+
+    return needed <= _order ? _order : _harmonicOrder;
+}
+
+template <typename SampleType>
+
+void OversampledDistortion<SampleType>::processBlock(juce::dsp::AudioBlock<SampleType>& block) noexcept
+{
+    //A fade under way is finished first, otherwise the selection may start, restart or drop a warm up
+    if (_incomingOrder == noOrder || _warmUpRemaining > 0)
+    {
+        const auto order = selectOrder();
+
+        if (order == _activeOrder)
+            _incomingOrder = noOrder;
+        else if (order != _incomingOrder)
+            startIncoming(order);
+    }
+
+    if (_incomingOrder == noOrder)
+    {
+        processPath(_activeOrder, block, _activeRing);
+        _modulation = {};
+        return;
+    }
+
+    const auto numChannels = juce::jmin(block.getNumChannels(), _numChannels);
+    const auto numSamples = (int) block.getNumSamples();
+
+    for (size_t channel = 0; channel < numChannels; ++channel)
+        _incoming.copyFrom((int) channel, 0, block.getChannelPointer(channel), numSamples);
+
+    juce::dsp::AudioBlock<SampleType> incoming (_incoming.getArrayOfWritePointers(), numChannels, (size_t) numSamples);
+
+    processPath(_incomingOrder, incoming, 1 - _activeRing);
+    processPath(_activeOrder, block, _activeRing);
+
+    //Silent until the warm up is over, then a linear fade from the playing path
+    auto warmUp = _warmUpRemaining;
+    auto fade = _fadePosition;
+
+    for (size_t channel = 0; channel < numChannels; ++channel)
+    {
+        auto* samples = block.getChannelPointer(channel);
+        const auto* incomingSamples = incoming.getChannelPointer(channel);
+
+        warmUp = _warmUpRemaining;
+        fade = _fadePosition;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            if (warmUp > 0)
+            {
+                --warmUp;
+                continue;
+            }
+
+            fade = juce::jmin(fade + 1, fadeLength);
+            const auto gain = static_cast<SampleType> (fade) / static_cast<SampleType> (fadeLength);
+            samples[i] += gain * (incomingSamples[i] - samples[i]);
+        }
+    }
+
+    _warmUpRemaining = warmUp;
+    _fadePosition = fade;
+
+    if (_fadePosition == fadeLength)
+    {
+        _activeOrder = _incomingOrder;
+        _activeRing = 1 - _activeRing;
+        _incomingOrder = noOrder;
+    }
+
+    _modulation = {};
+}
+
+template <typename SampleType>
+
+void OversampledDistortion<SampleType>::processPath(size_t order, juce::dsp::AudioBlock<SampleType>& block, size_t ring) noexcept
+{
+    auto& path = _paths[order];
+    auto& distortion = *path.distortion;
+
+    if (path.oversampling == nullptr)
+    {
+        distortion.setModulation(_modulation);
+        distortion.process(juce::dsp::ProcessContextReplacing<SampleType>(block));
+    }
+    else
+    {
+        const auto factor = (size_t) 1 << order;
+        auto modulation = _modulation;
+
+        if (modulation.isActive())
+        {
+            modulation.numSamples *= factor;
+            modulation.controlInterval *= (int) factor;
+        }
+
+        auto oversampledBlock = [this, &path, &block]
+        {
+            TraceRecorder::Scope span (_trace, "Oversampling up");
+            return path.oversampling->processSamplesUp(block);
+        }();
+
+        distortion.setModulation(modulation);
+        distortion.process(juce::dsp::ProcessContextReplacing<SampleType>(oversampledBlock));
+
+        {
+            TraceRecorder::Scope span (_trace, "Oversampling down");
+            path.oversampling->processSamplesDown(block);
+        }
+    }
+
+    processDelay(block, ring, _latency - getPathLatency(order));
+}
+
+template <typename SampleType>
+
+void OversampledDistortion<SampleType>::processDelay(juce::dsp::AudioBlock<SampleType>& block, size_t ring, int delaySamples) noexcept
+{
+    if (_latency == 0)
+        return;
+
+    //Each path keeps its own ring, its offset never changes while it plays
+    const auto numChannels = juce::jmin(block.getNumChannels(), _numChannels);
+    const auto numSamples = (int) block.getNumSamples();
+    auto& position = _delayPositions[ring];
+
+    for (size_t channel = 0; channel < numChannels; ++channel)
+    {
+        auto* delay = _delay.get() + (ring * _numChannels + channel) * (size_t) _delayLength;
+        auto* samples = block.getChannelPointer(channel);
+
+        auto write = position;
+        auto read = write - delaySamples;
+
+        if (read < 0)
+            read += _delayLength;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            delay[write] = samples[i];
+            samples[i] = delay[read];
+
+            if (++write == _delayLength)
+                write = 0;
+
+            if (++read == _delayLength)
+                read = 0;
+        }
+    }
+
+    position = (position + numSamples) % _delayLength;
+}
+
+template class OversampledDistortion<float>;
+template class OversampledDistortion<double>;
@@ -0,0 +1,140 @@
+/*
+  ==============================================================================
+
+    OversampledDistortion.h
+    Created: 19 Oct 2026 11:02:18pm
+    Author:  Alperen Kurbetci
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "Distortion.h"
+#include "AlignedBuffer.h"
+
+/*
+ The distortion run oversampled in SampleType precision, on a float block from the host.
+
+ A path is a Distortion and its resampling filters at one oversampling order. Only the orders
+ selectOrder() can pick are built: the prepared one, the base rate while a neural capture is
+ heard (trained at the host rate) or nothing but a linear harmonic design, and the order the
+ full harmonic design needs if that is higher than the prepared one.
+
+ A switch never cuts from one path to the other. The path coming in starts from a clean state
+ and runs next to the playing one, unheard, until its filters, its latency pad and its dc
+ blocker have settled. Then the two are crossfaded over one sub-block and the old one stops.
+ A selection that changes again during the warm up starts it over, so a setting flickering
+ around a boundary never gets heard. Each running path has its own pad up to the latency set
+ with setLatency(), so neither the switch nor a different oversampling setting changes what is
+ reported to the host.
+ */
+template <typename SampleType>
+
+class OversampledDistortion
+
+{
+public:
+
+    using FilterType = typename juce::dsp::Oversampling<SampleType>::FilterType;
+
+    OversampledDistortion();
+
+    /*
+     Allocates everything, including the oversampling filters of every path it builds: message
+     thread only. The order is log2 of the factor, 0 runs at the base rate.
+     */
+    void prepare(const juce::dsp::ProcessSpec& spec, size_t oversamplingOrder, FilterType filterType, bool maxQuality);
+
+    void reset();
+
+    ///Integer latency of the oversampling filters, the highest of all paths
+    int getOversamplingLatency() const noexcept;
+
+    ///Pads the output to latencySamples (not below getOversamplingLatency()), allocates the delay line
+    void setLatency(int latencySamples);
+    int getLatency() const noexcept { return _latency; }
+
+    ///Every path's distortion must get the same settings
+    template <typename Function>
+    void forEachDistortion(Function&& function)
+    {
+        for (auto& path : _paths)
+            if (path.distortion != nullptr)
+                function(*path.distortion);
+    }
+
+    //For the next process() call, the control points are stretched to the oversampled rate
+    void setModulation(const ModulationMatrix::Block& modulation) noexcept { _modulation = modulation; }
+
+    void setNeuralNetwork(const NeuralNetworkBase* newNetwork) noexcept;
+    
+    ///Spans for the resampling filters and every distortion, nullptr for none
+    void setTraceRecorder(TraceRecorder* recorder) noexcept;
+
+    ///In place, float in and out whatever the processing precision
+    void process(juce::dsp::AudioBlock<float>& block) noexcept;
+    
+    ///Per instance memory, the oversampling stages are estimated from their buffer sizes
+    size_t getMemoryFootprintBytes() const noexcept;
+
+private:
+
+    void processBlock(juce::dsp::AudioBlock<SampleType>& block) noexcept;
+    void processPath(size_t order, juce::dsp::AudioBlock<SampleType>& block, size_t ring) noexcept;
+    void processDelay(juce::dsp::AudioBlock<SampleType>& block, size_t ring, int delaySamples) noexcept;
+
+    //Order this block should run at, from what the distortion needs right now
+    size_t selectOrder() const noexcept;
+
+    //Starts the path of this order from silence next to the playing one
+    void startIncoming(size_t order) noexcept;
+    void resetPath(size_t order) noexcept;
+
+    int getPathLatency(size_t order) const noexcept;
+
+    static constexpr size_t maxOrder = 4;
+    static constexpr size_t noOrder = maxOrder + 1;
+
+  //Path 0 runs at the base rate and has no filters, the orders selectOrder() never picks stay empty
+    struct Path
+    {
+        std::unique_ptr<Distortion<SampleType>> distortion;
+        std::unique_ptr<juce::dsp::Oversampling<SampleType>> oversampling;
+    };
+
+    std::array<Path, maxOrder + 1> _paths;
+    size_t _order = 0;
+    size_t _harmonicOrder = 0;
+
+  //The playing path, and the one warming up or fading in (noOrder for none)
+    size_t _activeOrder = 0;
+    size_t _incomingOrder = noOrder;
+    int _warmUpRemaining = 0;
+    int _fadePosition = 0;
+
+  //Settling time of the dc blocker after a reset, on top of the latency
+    static constexpr double warmUpSeconds = 0.05;
+    int _warmUpLength = 0;
+
+  //The crossfade, one sub-block of the processor
+    static constexpr int fadeLength = 64;
+
+  //The input for the incoming path, the playing one works in place
+    juce::AudioBuffer<SampleType> _incoming;
+
+    ModulationMatrix::Block _modulation;
+    TraceRecorder* _trace = nullptr;
+
+  //Precision change for double processing
+    juce::AudioBuffer<SampleType> _conversion;
+
+  //Latency pad, two rings (playing and incoming path) of _delayLength per channel
+    int _latency = 0;
+    AlignedBuffer<SampleType> _delay;
+    int _delayLength = 1;
+    std::array<int, 2> _delayPositions {};
+    size_t _activeRing = 0;
+    size_t _numChannels = 0;
+    size_t _maxBlockSize = 0;
+};
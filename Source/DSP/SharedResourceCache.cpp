@@ -0,0 +1,73 @@
+/*
+  ==============================================================================
+
+    SharedResourceCache.cpp
+    Created: 19 Oct 2026 11:48:52pm
+    Author:  Alperen Kurbetci
+
+  ==============================================================================
+*/
+
+#include "SharedResourceCache.h"
+
+SharedResourceCache::SharedResourceCache()
+{
+
+}
+
+juce::String SharedResourceCache::getFileKey (const juce::File& file)
+{
+    return file.getFullPathName() + "@" + juce::String (file.getLastModificationTime().toMilliseconds())
+         + ":" + juce::String (file.getSize());
+}
+
+size_t SharedResourceCache::getMemoryFootprintBytes() const
+{
+    const juce::ScopedLock sl (_lock);
+    size_t total = 0;
+
+    for (const auto& [key, entry] : _entries)
+        if (! entry.resource.expired())
+            total += entry.numBytes;
+
+    return total;
+}
+
+int SharedResourceCache::getNumResources() const
+{
+    const juce::ScopedLock sl (_lock);
+    auto count = 0;
+
+    for (const auto& [key, entry] : _entries)
+        if (! entry.resource.expired())
+            ++count;
+
+    return count;
+}
+
+std::shared_ptr<const void> SharedResourceCache::find (const juce::String& key) const
+{
+    const juce::ScopedLock sl (_lock);
+
+    auto it = _entries.find (key);
+    return it != _entries.end() ? it->second.resource.lock() : nullptr;
+}
+
+std::shared_ptr<const void> SharedResourceCache::insert (const juce::String& key, std::shared_ptr<const void> resource, size_t numBytes)
+{
+    const juce::ScopedLock sl (_lock);
+
+    auto& entry = _entries[key];
+
+    if (auto existing = entry.resource.lock())
+        return existing;
+
+    entry.resource = resource;
+    entry.numBytes = numBytes;
+
+    //Whatever nobody uses any more goes now, so the map only ever holds what is alive
+    for (auto it = _entries.begin(); it != _entries.end();)
+        it = it->second.resource.expired() ? _entries.erase (it) : std::next (it);
+
+    return resource;
+}
@@ -0,0 +1,74 @@
+/*
+  ==============================================================================
+
+    SharedResourceCache.h
+    Created: 19 Oct 2026 11:48:52pm
+    Author:  Alperen Kurbetci
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+/*
+ Read-only DSP data shared by every BuzzBox instance in the process: lookup tables, filter
+ coefficients, resampled impulse responses and neural weights.
+
+ A key names the resource and everything it was built from (precision, sample rate, file and
+ modification time), so equal keys always mean equal contents. The cache only holds weak
+ references: a resource lives as long as one instance uses it, and the cache itself lives as
+ long as one instance holds a juce::SharedResourcePointer to it.
+
+ Builders run on the calling thread, which is a loader thread or the message thread, never
+ the audio thread. A resource type must have getMemoryFootprintBytes().
+ */
+class SharedResourceCache
+
+{
+public:
+
+    SharedResourceCache();
+
+    /*
+     Returns the resource for key, building it first if no instance holds it at the moment.
+     A builder that fails returns nullptr and nothing is cached.
+     */
+    template <typename ResourceType, typename Builder>
+    std::shared_ptr<const ResourceType> getOrBuild (const juce::String& key, Builder&& build)
+    {
+        if (auto existing = find (key))
+            return std::static_pointer_cast<const ResourceType> (existing);
+
+        //Built without the lock held, if two instances race for the same key the first one stored wins
+        std::shared_ptr<const ResourceType> resource = build();
+
+        if (resource == nullptr)
+            return nullptr;
+
+        return std::static_pointer_cast<const ResourceType> (insert (key, resource, resource->getMemoryFootprintBytes()));
+    }
+
+    ///Key part for a file, changes whenever the file is edited
+    static juce::String getFileKey (const juce::File& file);
+
+    ///Bytes held by every resource still in use, whichever instance built it
+    size_t getMemoryFootprintBytes() const;
+    int getNumResources() const;
+
+private:
+
+    std::shared_ptr<const void> find (const juce::String& key) const;
+    std::shared_ptr<const void> insert (const juce::String& key, std::shared_ptr<const void> resource, size_t numBytes);
+
+    struct Entry
+    {
+        std::weak_ptr<const void> resource;
+        size_t numBytes = 0;
+    };
+
+    mutable juce::CriticalSection _lock;
+    std::map<juce::String, Entry> _entries;
+
+    JUCE_DECLARE_NON_COPYABLE (SharedResourceCache)
+};
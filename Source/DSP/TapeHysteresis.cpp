@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    TapeHysteresis.cpp
+    Created: 20 Oct 2026 2:17:09am
+    Author:  Alperen Kurbetci
+
+  ==============================================================================
+*/
+
+#include "TapeHysteresis.h"
+
+template <typename SampleType>
+
+TapeHysteresis<SampleType>::TapeHysteresis()
+{
+
+}
+
+template <typename SampleType>
+
+void TapeHysteresis<SampleType>::prepare (double sampleRate, int numChannels)
+{
+    _sampleRate = static_cast<SampleType> (sampleRate);
+    _halfPeriod = static_cast<SampleType> (0.5 / sampleRate);
+
+    _numChannels = (size_t) numChannels;
+    _state.allocate (2 * _numChannels, true);
+
+    const auto tableKey = juce::String ("Tape Langevin/") + (std::is_same_v<SampleType, float> ? "float" : "double");
+    _langevin = _sharedResources->getOrBuild<LangevinTable> (tableKey, [] { return buildLangevinTable(); });
+}
+
+template <typename SampleType>
+
+void TapeHysteresis<SampleType>::reset()
+{
+    _state.clear();
+}
+
+template <typename SampleType>
+
+typename TapeHysteresis<SampleType>::Coefficients TapeHysteresis<SampleType>::getCoefficients() const noexcept
+{
+    Coefficients coefficients;
+
+    const auto saturation = SampleType (0.5) + SampleType (1.5) * (SampleType (1) - _saturation);
+    const auto width = saturation * widthPerSaturation;
+    const auto reversible = SampleType (0.05) + SampleType (0.9) * _bias;
+
+    coefficients.saturation = saturation;
+    coefficients.inverseWidth = SampleType (1) / width;
+    coefficients.saturationOverWidth = saturation / width;
+    coefficients.reversible = reversible;
+    coefficients.irreversible = SampleType (1) - reversible;
+    coefficients.pinning = width * pinningPerWidth;
+
+    //Small signals come out near unity whatever the saturation, full saturation at the default setting is full scale
+    coefficients.outputGain = SampleType (0.8);
+
+    return coefficients;
+}
+
+template <typename SampleType>
+
+std::shared_ptr<const typename TapeHysteresis<SampleType>::LangevinTable> TapeHysteresis<SampleType>::buildLangevinTable()
+{
+    auto table = std::make_shared<LangevinTable>();
+
+    for (int i = 0; i <= tableSize; ++i)
+    {
+        const auto x = (double) i / tableResolution;
+        double value, slope, curvature;
+
+        //coth (x) - 1 / x cancels near zero, the series is exact to double precision there
+        if (x < 0.05)
+        {
+            const auto x2 = x * x;
+            value     = x / 3.0 - x * x2 / 45.0 + 2.0 * x * x2 * x2 / 945.0;
+            slope     = 1.0 / 3.0 - x2 / 15.0 + 2.0 * x2 * x2 / 189.0;
+            curvature = -2.0 * x / 15.0 + 8.0 * x * x2 / 189.0;
+        }
+        else
+        {
+            const auto coth = 1.0 / std::tanh (x);
+            value     = coth - 1.0 / x;
+            slope     = 1.0 / (x * x) - coth * coth + 1.0;
+            curvature = 2.0 * coth * (coth * coth - 1.0) - 2.0 / (x * x * x);
+        }
+
+        table->values[(size_t) (3 * i)]     = static_cast<SampleType> (value);
+        table->values[(size_t) (3 * i + 1)] = static_cast<SampleType> (slope);
+        table->values[(size_t) (3 * i + 2)] = static_cast<SampleType> (curvature);
+    }
+
+    return table;
+}
+
+template class TapeHysteresis<float>;
+template class TapeHysteresis<double>;
@@ -0,0 +1,271 @@
+/*
+  ==============================================================================
+
+    TapeHysteresis.h
+    Created: 20 Oct 2026 2:17:09am
+    Author:  Alperen Kurbetci
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "AlignedBuffer.h"
+#include "SharedResourceCache.h"
+
+/*
+ Magnetic tape saturation after the Jiles-Atherton hysteresis model. The input is the field H,
+ the output the magnetisation M of the tape:
+
+     dM/dt = dH/dt * ((1 - c) dM (Man - M) / ((1 - c) d k - alpha (Man - M)) + c Ms / a L'(Q))
+                   / (1 - c alpha Ms / a L'(Q))
+
+     Man = Ms L(Q),  Q = (H + alpha M) / a,  L(x) = coth (x) - 1 / x (the Langevin function)
+
+ with d the sign of dH/dt, and dM 1 while M moves towards Man and 0 otherwise. Saturation sets
+ Ms (and a with it, so the small signal gain stays the same), bias sets the reversible share c:
+ more bias gives the narrower loop of a well biased tape.
+
+ H is linear between two input samples, so dH/dt is constant over a sample. Every sample is
+ solved in two steps (2x the processing rate) with Heun (RK2), RK4, or the trapezoidal rule
+ solved by Newton-Raphson. The Newton solver is bounded: at most maxIterations per step and M
+ kept inside the saturation, so the cost per sample is fixed whatever the signal.
+
+ L, L' and L'' come from a table shared by every instance (SharedResourceCache), a lookup is
+ two neighbouring triples and a linear interpolation. Past the table the asymptotes are exact.
+ The state is two values per channel: M and the last input sample.
+ */
+template <typename SampleType>
+
+class TapeHysteresis
+
+{
+public:
+
+    enum class Solver
+    {
+        cRK2,
+        cRK4,
+        cNewtonRaphson
+    };
+
+    TapeHysteresis();
+
+    void prepare (double sampleRate, int numChannels);
+
+    void reset();
+
+    ///0 - 1, more bias narrows the loop
+    void setBias (SampleType newBias) noexcept { _bias = juce::jlimit (SampleType (0), SampleType (1), newBias); }
+
+    ///0 - 1, more saturation lowers the level the tape compresses towards
+    void setSaturation (SampleType newSaturation) noexcept { _saturation = juce::jlimit (SampleType (0), SampleType (1), newSaturation); }
+
+    void setSolver (Solver newSolver) noexcept { _solver = newSolver; }
+
+    size_t getMemoryFootprintBytes() const noexcept { return _state.getSizeInBytes(); }
+
+    ///The driven signal in place, each channel keeps its own magnetisation
+    void process (SampleType* samples, int numSamples, int channel) noexcept
+    {
+        if (_langevin == nullptr || (size_t) channel >= _numChannels)
+            return;
+
+        //Worked out once per call, a parameter change meanwhile is picked up by the next one
+        const auto coefficients = getCoefficients();
+
+        switch (_solver)
+        {
+            case Solver::cRK2:           processWith<Solver::cRK2> (samples, numSamples, (size_t) channel, coefficients); break;
+            case Solver::cRK4:           processWith<Solver::cRK4> (samples, numSamples, (size_t) channel, coefficients); break;
+            case Solver::cNewtonRaphson: processWith<Solver::cNewtonRaphson> (samples, numSamples, (size_t) channel, coefficients); break;
+        }
+    }
+
+private:
+
+    struct Coefficients
+    {
+        SampleType saturation;
+        SampleType inverseWidth;
+        SampleType saturationOverWidth;
+        SampleType reversible;
+        SampleType irreversible;
+        SampleType pinning;
+        SampleType outputGain;
+    };
+
+    struct Langevin
+    {
+        SampleType value;
+        SampleType slope;
+        SampleType curvature;
+    };
+
+    Coefficients getCoefficients() const noexcept;
+
+    template <Solver solver>
+    void processWith (SampleType* samples, int numSamples, size_t channel, const Coefficients& coefficients) noexcept
+    {
+        auto m = _state[channel];
+        auto h = _state[_numChannels + channel];
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto next = samples[i];
+            const auto middle = SampleType (0.5) * (h + next);
+            const auto slope = (next - h) * _sampleRate;
+
+            m = step<solver> (m, h, middle, slope, coefficients);
+            m = step<solver> (m, middle, next, slope, coefficients);
+            h = next;
+
+            samples[i] = m * coefficients.outputGain;
+        }
+
+        _state[channel] = m;
+        _state[_numChannels + channel] = h;
+    }
+
+    ///One half sample from field start to field end
+    template <Solver solver>
+    SampleType step (SampleType m, SampleType start, SampleType end, SampleType slope, const Coefficients& coefficients) const noexcept
+    {
+        const auto limit = coefficients.saturation;
+        const auto dt = _halfPeriod;
+
+        if constexpr (solver == Solver::cRK2)
+        {
+            const auto k1 = getSlope (m, start, slope, coefficients);
+            const auto k2 = getSlope (m + dt * k1, end, slope, coefficients);
+
+            return juce::jlimit (-limit, limit, m + SampleType (0.5) * dt * (k1 + k2));
+        }
+        else if constexpr (solver == Solver::cRK4)
+        {
+            const auto middle = SampleType (0.5) * (start + end);
+            const auto k1 = getSlope (m, start, slope, coefficients);
+            const auto k2 = getSlope (m + SampleType (0.5) * dt * k1, middle, slope, coefficients);
+            const auto k3 = getSlope (m + SampleType (0.5) * dt * k2, middle, slope, coefficients);
+            const auto k4 = getSlope (m + dt * k3, end, slope, coefficients);
+
+            return juce::jlimit (-limit, limit, m + dt / SampleType (6) * (k1 + SampleType (2) * (k2 + k3) + k4));
+        }
+        else
+        {
+            //m1 = m + dt / 2 (f (m) + f (m1)), started from the Euler guess
+            const auto known = m + SampleType (0.5) * dt * getSlope (m, start, slope, coefficients);
+            auto next = juce::jlimit (-limit, limit, known + SampleType (0.5) * dt * getSlope (m, end, slope, coefficients));
+
+            for (int iteration = 0; iteration < maxIterations; ++iteration)
+            {
+                SampleType derivative;
+                const auto f = getSlope (next, end, slope, coefficients, &derivative);
+
+                //f falls with M wherever the tape relaxes, the floor keeps a rising f from flipping the step
+                const auto g = next - known - SampleType (0.5) * dt * f;
+                const auto dg = juce::jmax (minimumDerivative, SampleType (1) - SampleType (0.5) * dt * derivative);
+                const auto delta = g / dg;
+
+                next = juce::jlimit (-limit, limit, next - delta);
+
+                if (std::abs (delta) < tolerance)
+                    break;
+            }
+
+            return next;
+        }
+    }
+
+    ///dM/dt, and its derivative by M for the Newton solver
+    SampleType getSlope (SampleType m, SampleType h, SampleType slope, const Coefficients& coefficients,
+                         SampleType* derivative = nullptr) const noexcept
+    {
+        const auto langevin = getLangevin ((h + alpha * m) * coefficients.inverseWidth);
+        const auto difference = coefficients.saturation * langevin.value - m;
+        const auto direction = slope >= SampleType (0) ? SampleType (1) : SampleType (-1);
+
+        //The irreversible part only ever pulls M towards the anhysteretic curve
+        const auto moving = difference * direction > SampleType (0) ? coefficients.irreversible : SampleType (0);
+        const auto pinned = coefficients.irreversible * direction * coefficients.pinning;
+        const auto denominator = pinned - alpha * difference;
+
+        const auto irreversible = moving * difference / denominator;
+        const auto reversible = coefficients.reversible * coefficients.saturationOverWidth * langevin.slope;
+        const auto coupling = SampleType (1) - alpha * reversible;
+        const auto numerator = irreversible + reversible;
+
+        if (derivative != nullptr)
+        {
+            const auto dQ = alpha * coefficients.inverseWidth;
+            const auto dDifference = coefficients.saturation * langevin.slope * dQ - SampleType (1);
+            const auto dIrreversible = moving * pinned * dDifference / (denominator * denominator);
+            const auto dReversible = coefficients.reversible * coefficients.saturationOverWidth * langevin.curvature * dQ;
+
+            *derivative = slope * ((dIrreversible + dReversible) * coupling + numerator * alpha * dReversible) / (coupling * coupling);
+        }
+
+        return slope * numerator / coupling;
+    }
+
+    Langevin getLangevin (SampleType q) const noexcept
+    {
+        const auto x = std::abs (q);
+        const auto sign = q < SampleType (0) ? SampleType (-1) : SampleType (1);
+
+        //coth is 1 to well below float precision out here
+        if (x >= tableRange)
+        {
+            const auto inverse = SampleType (1) / x;
+            return { sign * (SampleType (1) - inverse), inverse * inverse, -sign * SampleType (2) * inverse * inverse * inverse };
+        }
+
+        const auto position = x * SampleType (tableResolution);
+        const auto index = (int) position;
+        const auto fraction = position - SampleType (index);
+        const auto* values = _langevin->values.data() + 3 * index;
+
+        return { sign * (values[0] + fraction * (values[3] - values[0])),
+                 values[1] + fraction * (values[4] - values[1]),
+                 sign * (values[2] + fraction * (values[5] - values[2])) };
+    }
+
+    //L, L' and L'' at every grid point next to each other, so a lookup reads one short run
+    static constexpr int tableResolution = 128;
+    static constexpr int tableSize = 8 * tableResolution;
+    static constexpr SampleType tableRange = SampleType (tableSize) / SampleType (tableResolution);
+
+    struct LangevinTable
+    {
+        std::array<SampleType, 3 * (tableSize + 1)> values {};
+
+        size_t getMemoryFootprintBytes() const noexcept { return sizeof (*this); }
+    };
+
+    static std::shared_ptr<const LangevinTable> buildLangevinTable();
+
+    //Mean field coupling, from the published fits of ferric oxide tape
+    static constexpr SampleType alpha = SampleType (1.6e-3);
+
+    //Anhysteretic width a per Ms and pinning k per a, these set the shape of the loop
+    static constexpr SampleType widthPerSaturation = SampleType (2.0 / 15.0);
+    static constexpr SampleType pinningPerWidth = SampleType (1.15);
+
+    static constexpr int maxIterations = 3;
+    static constexpr SampleType tolerance = SampleType (1.0e-6);
+    static constexpr SampleType minimumDerivative = SampleType (0.1);
+
+    SampleType _sampleRate = SampleType (48000);
+    SampleType _halfPeriod = SampleType (0.5 / 48000.0);
+
+    SampleType _bias = SampleType (0.5);
+    SampleType _saturation = SampleType (0.5);
+    Solver _solver = Solver::cRK2;
+
+    juce::SharedResourcePointer<SharedResourceCache> _sharedResources;
+    std::shared_ptr<const LangevinTable> _langevin;
+
+    //The magnetisation of every channel, then the last input sample of every channel
+    AlignedBuffer<SampleType> _state;
+    size_t _numChannels = 0;
+};
@@ -0,0 +1,160 @@
+/*
+  ==============================================================================
+
+    TraceRecorder.cpp
+    Created: 20 Oct 2026 12:21:35am
+    Author:  Alperen Kurbetci
+
+  ==============================================================================
+*/
+
+#include "TraceRecorder.h"
+
+TraceRecorder::TraceRecorder()
+{
+
+}
+
+TraceRecorder::~TraceRecorder()
+{
+    stop();
+}
+
+bool TraceRecorder::start (const juce::File& file)
+{
+    stop();
+
+    if (_slots == nullptr)
+    {
+        _slots = std::make_unique<Slot[]> (ringSize);
+
+        for (size_t i = 0; i < ringSize; ++i)
+            _slots[i].sequence.store (i);
+    }
+    else
+    {
+        //Spans that came in after the last stop() belong to no file
+        drain();
+    }
+
+    const juce::ScopedLock sl (_writeLock);
+
+    file.deleteFile();
+    _stream = std::make_unique<juce::FileOutputStream> (file);
+
+    if (_stream->failedToOpen())
+    {
+        _stream.reset();
+        return false;
+    }
+
+    _stream->writeText ("{\"traceEvents\":[\n", false, false, nullptr);
+    _firstEvent = true;
+    _dropped.store (0);
+
+    _writer = std::make_unique<juce::SharedResourcePointer<TraceWriterThread>>();
+    (*_writer)->addRecorder (this);
+
+    //Publishes the ring and the stream to every thread that sees the flag
+    _recording.store (true, std::memory_order_release);
+    return true;
+}
+
+void TraceRecorder::stop()
+{
+    if (_writer == nullptr)
+        return;
+
+    _recording.store (false);
+
+    //Waits for a drain in progress, the writer thread does not see this recorder after this
+    (*_writer)->removeRecorder (this);
+    _writer.reset();
+
+    drain();
+
+    const juce::ScopedLock sl (_writeLock);
+
+    if (_stream != nullptr)
+    {
+        _stream->writeText ("\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"droppedSpans\":"
+                            + juce::String (_dropped.load()) + "}}\n", false, false, nullptr);
+        _stream.reset();
+    }
+}
+
+void TraceRecorder::drain()
+{
+    const juce::ScopedLock sl (_writeLock);
+
+    //Microseconds on the high resolution clock, so the files of several instances line up
+    const auto microsecondsPerTick = 1.0e6 / (double) juce::Time::getHighResolutionTicksPerSecond();
+    const auto processId = juce::String (juce::SystemStats::getProcessId());
+
+    for (;;)
+    {
+        auto& slot = _slots[(size_t) (_readPosition & ringMask)];
+
+        if (slot.sequence.load (std::memory_order_acquire) != _readPosition + 1)
+            break;
+
+        const auto span = slot.span;
+        slot.sequence.store (_readPosition + ringSize, std::memory_order_release);
+        ++_readPosition;
+
+        if (_stream == nullptr)
+            continue;
+
+        juce::String event;
+        event << (_firstEvent ? "" : ",\n")
+              << "{\"name\":\"" << span.name << "\",\"cat\":\"BuzzBox\",\"ph\":\"X\""
+              << ",\"pid\":" << processId
+              << ",\"tid\":" << juce::String ((juce::int64) (reinterpret_cast<juce::pointer_sized_uint> (span.thread) & 0x7fffffff))
+              << ",\"ts\":" << juce::String ((double) span.startTicks * microsecondsPerTick, 3)
+              << ",\"dur\":" << juce::String ((double) (span.endTicks - span.startTicks) * microsecondsPerTick, 3) << "}";
+
+        _stream->writeText (event, false, false, nullptr);
+        _firstEvent = false;
+    }
+
+    if (_stream != nullptr)
+        _stream->flush();
+}
+
+//==============================================================================
+TraceWriterThread::TraceWriterThread() : juce::Thread ("BuzzBox Trace Writer")
+{
+    startThread();
+}
+
+TraceWriterThread::~TraceWriterThread()
+{
+    stopThread (2000);
+}
+
+void TraceWriterThread::addRecorder (TraceRecorder* recorder)
+{
+    const juce::ScopedLock sl (_lock);
+    _recorders.addIfNotAlreadyThere (recorder);
+}
+
+void TraceWriterThread::removeRecorder (TraceRecorder* recorder)
+{
+    const juce::ScopedLock sl (_lock);
+    _recorders.removeFirstMatchingValue (recorder);
+}
+
+void TraceWriterThread::run()
+{
+    while (! threadShouldExit())
+    {
+        {
+            const juce::ScopedLock sl (_lock);
+
+            for (auto* recorder : _recorders)
+                recorder->drain();
+        }
+
+        wait (50);
+    }
+}
@@ -0,0 +1,164 @@
+/*
+  ==============================================================================
+
+    TraceRecorder.h
+    Created: 20 Oct 2026 12:21:35am
+    Author:  Alperen Kurbetci
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+/*
+ Opt-in timeline of what the audio thread spends its time on, one recorder per instance.
+
+ A span is a name (a string literal) with start and end ticks. Spans are pushed into a ring
+ allocated by start(). Any thread may push, so a span from a loader or the message thread is
+ recorded too. A bounded queue with a sequence number per slot keeps the push lock
+ free. Spans that do not fit are dropped and counted.
+
+ A shared writer thread drains the rings of every recording instance into Chrome trace event
+ JSON, which chrome://tracing and ui.perfetto.dev open as they are. While not recording, a Scope
+ costs one load and one well predicted branch.
+ */
+class TraceWriterThread;
+
+class TraceRecorder
+
+{
+public:
+
+    TraceRecorder();
+    ~TraceRecorder();
+
+    ///Message thread: allocates the ring on first use, truncates the file and starts writing to it
+    bool start (const juce::File& file);
+
+    ///Message thread: writes out what is left and closes the file
+    void stop();
+
+    ///Acquire, pairs with the release in start(): a caller that sees true also sees the ring it allocated
+    bool isRecording() const noexcept { return _recording.load (std::memory_order_acquire); }
+
+    ///Any thread, never blocks or allocates
+    void record (const char* name, juce::int64 startTicks, juce::int64 endTicks) noexcept
+    {
+        auto position = _writePosition.load (std::memory_order_relaxed);
+
+        for (;;)
+        {
+            auto& slot = _slots[(size_t) (position & ringMask)];
+            const auto sequence = slot.sequence.load (std::memory_order_acquire);
+            const auto difference = (juce::int64) (sequence - position);
+
+            if (difference == 0)
+            {
+                if (_writePosition.compare_exchange_weak (position, position + 1, std::memory_order_relaxed))
+                {
+                    slot.span = { name, startTicks, endTicks, juce::Thread::getCurrentThreadId() };
+                    slot.sequence.store (position + 1, std::memory_order_release);
+                    return;
+                }
+            }
+            else if (difference < 0)
+            {
+                _dropped.fetch_add (1, std::memory_order_relaxed);
+                return;
+            }
+            else
+            {
+                position = _writePosition.load (std::memory_order_relaxed);
+            }
+        }
+    }
+
+    ///Times everything until the end of the enclosing block, recorder may be nullptr
+    class Scope
+
+    {
+    public:
+
+        Scope (TraceRecorder* recorder, const char* name) noexcept
+            : _recorder (recorder != nullptr && recorder->isRecording() ? recorder : nullptr), _name (name)
+        {
+            if (_recorder != nullptr)
+                _start = juce::Time::getHighResolutionTicks();
+        }
+
+        ~Scope()
+        {
+            if (_recorder != nullptr)
+                _recorder->record (_name, _start, juce::Time::getHighResolutionTicks());
+        }
+
+    private:
+
+        TraceRecorder* _recorder;
+        const char* _name;
+        juce::int64 _start = 0;
+
+        JUCE_DECLARE_NON_COPYABLE (Scope)
+    };
+
+private:
+
+    friend class TraceWriterThread;
+
+    struct Span
+    {
+        const char* name = nullptr;
+        juce::int64 startTicks = 0;
+        juce::int64 endTicks = 0;
+        juce::Thread::ThreadID thread = nullptr;
+    };
+
+    struct Slot
+    {
+        std::atomic<juce::uint64> sequence { 0 };
+        Span span;
+    };
+
+    ///Writer thread (or stop()): pops everything pushed so far into the file
+    void drain();
+
+    //Far more spans than a drain interval holds, even with tiny host blocks
+    static constexpr size_t ringSize = 1 << 16;
+    static constexpr juce::uint64 ringMask = ringSize - 1;
+
+    std::unique_ptr<Slot[]> _slots;
+    std::atomic<juce::uint64> _writePosition { 0 };
+    juce::uint64 _readPosition = 0;
+    std::atomic<bool> _recording { false };
+    std::atomic<juce::uint32> _dropped { 0 };
+
+    //Writer side, guarded by the lock so stop() and the writer thread never write at the same time
+    juce::CriticalSection _writeLock;
+    std::unique_ptr<juce::FileOutputStream> _stream;
+    bool _firstEvent = true;
+    std::unique_ptr<juce::SharedResourcePointer<TraceWriterThread>> _writer;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TraceRecorder)
+};
+
+//==============================================================================
+///One thread drains the recorders of every BuzzBox instance in the process
+class TraceWriterThread : private juce::Thread
+
+{
+public:
+
+    TraceWriterThread();
+    ~TraceWriterThread() override;
+
+    void addRecorder (TraceRecorder* recorder);
+    void removeRecorder (TraceRecorder* recorder);
+
+private:
+
+    void run() override;
+
+    juce::CriticalSection _lock;
+    juce::Array<TraceRecorder*> _recorders;
+};
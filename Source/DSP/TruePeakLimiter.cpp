@@ -0,0 +1,163 @@
+/*
+  ==============================================================================
+
+    TruePeakLimiter.cpp
+    Created: 19 Oct 2026 7:36:14pm
+    Author:  Alperen Kurbetci
+
+  ==============================================================================
+*/
+
+#include "TruePeakLimiter.h"
+
+namespace
+{
+    //Modified Bessel function of the first kind, order 0 (for the Kaiser window)
+    double besselI0 (double x)
+    {
+        auto sum = 1.0;
+        auto term = 1.0;
+
+        for (int k = 1; k < 32; ++k)
+        {
+            term *= (x * 0.5 / k) * (x * 0.5 / k);
+            sum += term;
+        }
+
+        return sum;
+    }
+}
+
+template <typename SampleType>
+
+TruePeakLimiter<SampleType>::TruePeakLimiter()
+{
+
+}
+
+template <typename SampleType>
+
+void TruePeakLimiter<SampleType>::prepare (const juce::dsp::ProcessSpec& spec)
+{
+    _numChannels = spec.numChannels;
+    _lookahead = juce::jmax (1, juce::roundToInt (lookaheadSeconds * spec.sampleRate));
+    _delayLength = _lookahead - 1 + interpolationDelay;
+    _inverseLookahead = 1.0 / _lookahead;
+    _releaseCoefficient = static_cast<SampleType> (1.0 - std::exp (-1.0 / (releaseSeconds * spec.sampleRate)));
+
+    const auto key = juce::String ("Limiter interpolators/") + (std::is_same_v<SampleType, float> ? "float" : "double");
+    _interpolators = _sharedResources->getOrBuild<Interpolators> (key, [] { return buildInterpolators(); });
+
+    _history.allocate (_numChannels * 2 * numTaps, true);
+    _historyPosition.assign (_numChannels, 0);
+    _delay.allocate (_numChannels * (size_t) _delayLength, true);
+
+    _minValues.assign ((size_t) _lookahead, SampleType (1));
+    _minIndices.assign ((size_t) _lookahead, 0);
+    _average.assign ((size_t) _lookahead, SampleType (1));
+
+    reset();
+}
+
+template <typename SampleType>
+
+std::shared_ptr<const typename TruePeakLimiter<SampleType>::Interpolators> TruePeakLimiter<SampleType>::buildInterpolators()
+{
+    //Phase p estimates the signal p/4 of a sample after the tap interpolationDelay back
+    constexpr double beta = 6.0;
+    auto interpolators = std::make_shared<Interpolators>();
+    interpolators->coefficients.allocate ((size_t) ((numPhases - 1) * numTaps), true);
+
+    for (int phase = 1; phase < numPhases; ++phase)
+    {
+        auto* row = interpolators->coefficients.get() + (phase - 1) * numTaps;
+        const auto centre = (double) (numTaps - 1 - interpolationDelay) + (double) phase / numPhases;
+        auto sum = 0.0;
+
+        for (int k = 0; k < numTaps; ++k)
+        {
+            const auto t = (double) k - centre;
+            const auto sinc = t == 0.0 ? 1.0 : std::sin (juce::MathConstants<double>::pi * t) / (juce::MathConstants<double>::pi * t);
+            const auto r = t / (numTaps * 0.5);
+            const auto window = std::abs (r) < 1.0 ? besselI0 (beta * std::sqrt (1.0 - r * r)) / besselI0 (beta) : 0.0;
+
+            row[k] = static_cast<SampleType> (sinc * window);
+            sum += sinc * window;
+        }
+
+        //Unity gain at DC
+        for (int k = 0; k < numTaps; ++k)
+            row[k] = static_cast<SampleType> (row[k] / sum);
+    }
+
+    return interpolators;
+}
+
+template <typename SampleType>
+
+size_t TruePeakLimiter<SampleType>::getMemoryFootprintBytes() const noexcept
+{
+    return sizeof (*this) + _history.getSizeInBytes() + _delay.getSizeInBytes()
+         + _historyPosition.capacity() * sizeof (int)
+         + (_minValues.capacity() + _average.capacity()) * sizeof (SampleType)
+         + _minIndices.capacity() * sizeof (juce::int64);
+}
+
+template <typename SampleType>
+
+void TruePeakLimiter<SampleType>::reset()
+{
+    _delay.clear();
+    _delayPosition = 0;
+
+    resetGain();
+}
+
+template <typename SampleType>
+
+void TruePeakLimiter<SampleType>::resetGain() noexcept
+{
+    _history.clear();
+    std::fill (_historyPosition.begin(), _historyPosition.end(), 0);
+
+    _minFront = 0;
+    _minCount = 0;
+    _sampleIndex = 0;
+
+    std::fill (_average.begin(), _average.end(), SampleType (1));
+    _averagePosition = 0;
+    _averageSum = (double) _lookahead;
+
+    _gain = SampleType (1);
+}
+
+template <typename SampleType>
+
+void TruePeakLimiter<SampleType>::primeGain() noexcept
+{
+    resetGain();
+
+    //The same state as if the limiter had been on since these samples came in
+    const auto ceiling = _ceiling.load (std::memory_order_relaxed);
+
+    for (int k = 0; k < _delayLength; ++k)
+    {
+        const auto position = (_delayPosition + k) % _delayLength;
+        auto peak = SampleType (0);
+
+        for (size_t channel = 0; channel < _numChannels; ++channel)
+            peak = juce::jmax (peak, detectTruePeak (channel, _delay.get()[channel * (size_t) _delayLength + (size_t) position]));
+
+        processGain (peak > ceiling ? ceiling / peak : SampleType (1));
+    }
+}
+
+template <typename SampleType>
+
+void TruePeakLimiter<SampleType>::setCeiling (SampleType newCeilingDecibels) noexcept
+{
+    _ceiling.store (juce::Decibels::decibelsToGain (newCeilingDecibels));
+}
+
+template class TruePeakLimiter<float>;
+template class TruePeakLimiter<double>;
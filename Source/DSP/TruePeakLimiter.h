@@ -0,0 +1,225 @@
+/*
+  ==============================================================================
+
+    TruePeakLimiter.h
+    Created: 19 Oct 2026 7:36:14pm
+    Author:  Alperen Kurbetci
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "AlignedBuffer.h"
+#include "SharedResourceCache.h"
+
+/*
+ Lookahead limiter for the end of the chain, all channels share one gain.
+
+ Peaks are measured 4x oversampled: besides every sample, three polyphase windowed sinc
+ filters (12 taps each) estimate the signal between it and the next one, so overshoots
+ the DAC would make between samples are caught too.
+
+ Gain path for a lookahead of L samples:
+   target gain  min(1, ceiling / peak)
+   hold         minimum over the last L targets, a monotonic deque so it is O(1) per sample
+   attack       moving average over L, reaches the held minimum exactly when the peak leaves the delay line
+   release      one pole, it only ever raises the gain more slowly so it can not let a peak through
+ */
+template <typename SampleType>
+
+class TruePeakLimiter
+
+{
+public:
+
+    TruePeakLimiter();
+
+    void prepare (const juce::dsp::ProcessSpec& spec);
+
+    void reset();
+
+    void setCeiling (SampleType newCeilingDecibels) noexcept;
+    void setEnabled (bool shouldBeEnabled) noexcept { _enabled.store (shouldBeEnabled); }
+    bool isEnabled() const noexcept { return _enabled.load(); }
+
+    ///Per instance memory, the shared interpolators not included
+    size_t getMemoryFootprintBytes() const noexcept;
+
+    ///Lookahead plus the delay of the peak interpolators
+    int getLatencySamples() const noexcept { return _lookahead - 1 + interpolationDelay; }
+
+    /*
+     Replacing contexts only. When disabled the audio still goes through the delay line, so the
+     latency is the same either way and switching never moves the output in time.
+     */
+    template <typename ProcessContext>
+    void process (const ProcessContext& context) noexcept
+    {
+        const bool enabled = _enabled.load (std::memory_order_relaxed);
+        const bool wasEnabled = std::exchange (_wasEnabled, enabled);
+
+        if (context.isBypassed)
+            return;
+
+        //Switched on while playing, the gain has to see what is already in the delay line
+        if (enabled && ! wasEnabled)
+            primeGain();
+
+        auto& outputBlock = context.getOutputBlock();
+        const auto numChannels = juce::jmin (outputBlock.getNumChannels(), _numChannels);
+        const auto numSamples  = outputBlock.getNumSamples();
+        const auto ceiling = _ceiling.load (std::memory_order_relaxed);
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            auto gain = SampleType (1);
+
+            if (enabled)
+            {
+                auto peak = SampleType (0);
+
+                for (size_t channel = 0; channel < numChannels; ++channel)
+                    peak = juce::jmax (peak, detectTruePeak (channel, outputBlock.getSample ((int) channel, (int) i)));
+
+                gain = processGain (peak > ceiling ? ceiling / peak : SampleType (1));
+            }
+
+            for (size_t channel = 0; channel < numChannels; ++channel)
+            {
+                auto* delayLine = _delay.get() + channel * (size_t) _delayLength;
+                auto* samples = outputBlock.getChannelPointer (channel);
+
+                const auto delayed = delayLine[_delayPosition];
+                delayLine[_delayPosition] = samples[i];
+                samples[i] = delayed * gain;
+            }
+
+            if (++_delayPosition == _delayLength)
+                _delayPosition = 0;
+        }
+    }
+
+private:
+
+    ///Clears the detector and the gain path, the delay line is kept
+    void resetGain() noexcept;
+
+    ///Starts the gain path over and runs it on the delay line's contents, oldest first
+    void primeGain() noexcept;
+
+    ///Pushes one sample into the channel's interpolator, returns the largest of the sample interpolationDelay back and the three points after it
+    SampleType detectTruePeak (size_t channel, SampleType input) noexcept
+    {
+        //Written twice so the taps are always one contiguous run
+        auto* history = _history.get() + channel * 2 * numTaps;
+        auto& position = _historyPosition[channel];
+
+        history[position] = history[position + numTaps] = input;
+        position = position + 1 == numTaps ? 0 : position + 1;
+
+        const auto* taps = history + position;
+        auto peak = std::abs (taps[numTaps - 1 - interpolationDelay]);
+
+        for (int phase = 0; phase < numPhases - 1; ++phase)
+        {
+            const auto* coefficients = _interpolators->coefficients.get() + phase * numTaps;
+            auto sum = SampleType (0);
+
+            for (int k = 0; k < numTaps; ++k)
+                sum += coefficients[k] * taps[k];
+
+            peak = juce::jmax (peak, std::abs (sum));
+        }
+
+        return peak;
+    }
+
+    SampleType processGain (SampleType targetGain) noexcept
+    {
+        //Sliding minimum, the front of the deque is the smallest target in the window
+        if (_minCount > 0 && _minIndices[(size_t) _minFront] <= _sampleIndex - _lookahead)
+        {
+            _minFront = (_minFront + 1) % _lookahead;
+            --_minCount;
+        }
+
+        while (_minCount > 0 && _minValues[(size_t) back()] >= targetGain)
+            --_minCount;
+
+        const auto slot = (_minFront + _minCount) % _lookahead;
+        _minValues[(size_t) slot] = targetGain;
+        _minIndices[(size_t) slot] = _sampleIndex;
+        ++_minCount;
+        ++_sampleIndex;
+
+        //Moving average of the held minimum
+        const auto held = _minValues[(size_t) _minFront];
+        _averageSum += (double) held - (double) _average[(size_t) _averagePosition];
+        _average[(size_t) _averagePosition] = held;
+        _averagePosition = _averagePosition + 1 == _lookahead ? 0 : _averagePosition + 1;
+
+        const auto attacked = static_cast<SampleType> (_averageSum * _inverseLookahead);
+
+        if (attacked < _gain)
+            _gain = attacked;
+        else
+            _gain += (attacked - _gain) * _releaseCoefficient;
+
+        return _gain;
+    }
+
+    int back() const noexcept { return (_minFront + _minCount - 1) % _lookahead; }
+
+    static constexpr int numPhases = 4;
+    static constexpr int numTaps = 12;
+    static constexpr int interpolationDelay = numTaps / 2;
+
+    static constexpr double lookaheadSeconds = 0.002;
+    static constexpr double releaseSeconds = 0.1;
+
+    std::atomic<bool> _enabled { false };
+    bool _wasEnabled = false;
+    std::atomic<SampleType> _ceiling { SampleType (1) };
+
+    size_t _numChannels = 0;
+    int _lookahead = 1;
+    int _delayLength = 1;
+    double _inverseLookahead = 1.0;
+    SampleType _releaseCoefficient = SampleType (1);
+
+    //Interpolators, numPhases - 1 rows of numTaps. The same at every rate, so one copy for the process
+    struct Interpolators
+    {
+        AlignedBuffer<SampleType> coefficients;
+
+        size_t getMemoryFootprintBytes() const noexcept { return sizeof (*this) + coefficients.getSizeInBytes(); }
+    };
+
+    static std::shared_ptr<const Interpolators> buildInterpolators();
+
+    juce::SharedResourcePointer<SharedResourceCache> _sharedResources;
+    std::shared_ptr<const Interpolators> _interpolators;
+
+    //Doubled history per channel
+    AlignedBuffer<SampleType> _history;
+    std::vector<int> _historyPosition;
+
+    //Audio delay line per channel
+    AlignedBuffer<SampleType> _delay;
+    int _delayPosition = 0;
+
+    //Monotonic deque of the last _lookahead targets
+    std::vector<SampleType> _minValues;
+    std::vector<juce::int64> _minIndices;
+    int _minFront = 0;
+    int _minCount = 0;
+    juce::int64 _sampleIndex = 0;
+
+    //Attack average
+    std::vector<SampleType> _average;
+    int _averagePosition = 0;
+    double _averageSum = 0.0;
+
+    SampleType _gain = SampleType (1);
+};
@@ -1,29 +1,108 @@
-/*
-  ==============================================================================
-
-    Globals.cpp
-    Created: 12 Mar 2023 12:37:13pm
-    Author:  Alperen Kurbetci
-
-  ==============================================================================
-*/
-
-//Global vars to acces easily
-
-#include "Globals.h"
-
-const juce::String disModelID      = "disModel";
-const juce::String disModelName    = "Distortion Model";
-
-const juce::String inputID      = "input";
-const juce::String inputName    = "Input";
-
-const juce::String outputID        = "output";
-const juce::String outputName      = "Output";
-
-const juce::String mixID        = "mix";
-const juce::String mixName      = "Mix";
-
-
-//For future models such as fuzz
-float MaxVal = 1.0f;
+/*
+  ==============================================================================
+
+    Globals.cpp
+    Created: 12 Mar 2023 12:37:13pm
+    Author:  Alperen Kurbetci
+
+  ==============================================================================
+*/
+
+//Global vars to acces easily
+
+#include "Globals.h"
+
+const juce::String disModelID      = "disModel";
+const juce::String disModelName    = "Distortion Model";
+
+const juce::String inputID      = "input";
+const juce::String inputName    = "Input";
+
+const juce::String outputID        = "output";
+const juce::String outputName      = "Output";
+
+const juce::String mixID        = "mix";
+const juce::String mixName      = "Mix";
+
+const juce::String cabinetID    = "cabinet";
+const juce::String cabinetName  = "Cabinet";
+
+const juce::String limiterID    = "limiter";
+const juce::String limiterName  = "Limiter";
+
+const juce::String ceilingID    = "ceiling";
+const juce::String ceilingName  = "Ceiling";
+
+const juce::String autoGainID   = "autoGain";
+const juce::String autoGainName = "Auto Gain";
+
+const juce::String stereoModeID    = "stereoMode";
+const juce::String stereoModeName  = "Stereo Mode";
+
+const juce::String disModel2ID     = "disModel2";
+const juce::String disModel2Name   = "Distortion Model R/S";
+
+const juce::String input2ID     = "input2";
+const juce::String input2Name   = "Input R/S";
+
+const juce::String mix2ID       = "mix2";
+const juce::String mix2Name     = "Mix R/S";
+
+const juce::String sidechainDriveID     = "sidechainDrive";
+const juce::String sidechainDriveName   = "Sidechain Drive";
+
+const juce::String sidechainMixID       = "sidechainMix";
+const juce::String sidechainMixName     = "Sidechain Mix";
+
+const juce::String blendModelID     = "blendModel";
+const juce::String blendModelName   = "Blend Model";
+
+const juce::String blendID          = "blend";
+const juce::String blendName        = "Model Blend";
+
+const juce::String tapeBiasID           = "tapeBias";
+const juce::String tapeBiasName         = "Tape Bias";
+
+const juce::String tapeSaturationID     = "tapeSaturation";
+const juce::String tapeSaturationName   = "Tape Saturation";
+
+const juce::String tapeSolverID         = "tapeSolver";
+const juce::String tapeSolverName       = "Tape Solver";
+
+const juce::String foldShapeID          = "foldShape";
+const juce::String foldShapeName        = "Fold Shape";
+
+const juce::String shaperBiasID         = "shaperBias";
+const juce::String shaperBiasName       = "Shaper Bias";
+
+const juce::String bypassID             = "bypass";
+const juce::String bypassName           = "Bypass";
+
+const juce::String harmonicIDs[numHarmonicLevels]    = { "harmonic2", "harmonic3", "harmonic4", "harmonic5", "harmonic6", "harmonic7", "harmonic8" };
+const juce::String harmonicNames[numHarmonicLevels]  = { "Harmonic 2", "Harmonic 3", "Harmonic 4", "Harmonic 5", "Harmonic 6", "Harmonic 7", "Harmonic 8" };
+
+const juce::String numStagesID          = "numStages";
+const juce::String numStagesName        = "Stages";
+
+const juce::String stageModelIDs[numExtraStages]    = { "stage2Model", "stage3Model", "stage4Model" };
+const juce::String stageModelNames[numExtraStages]  = { "Stage 2 Model", "Stage 3 Model", "Stage 4 Model" };
+const juce::String stageDriveIDs[numExtraStages]    = { "stage2Drive", "stage3Drive", "stage4Drive" };
+const juce::String stageDriveNames[numExtraStages]  = { "Stage 2 Drive", "Stage 3 Drive", "Stage 4 Drive" };
+const juce::String stageToneIDs[numExtraStages]     = { "stage2Tone", "stage3Tone", "stage4Tone" };
+const juce::String stageToneNames[numExtraStages]   = { "Stage 2 Tone", "Stage 3 Tone", "Stage 4 Tone" };
+
+const juce::String lfoRateIDs[numLfos]     = { "lfo1Rate", "lfo2Rate" };
+const juce::String lfoRateNames[numLfos]   = { "LFO 1 Rate", "LFO 2 Rate" };
+const juce::String lfoShapeIDs[numLfos]    = { "lfo1Shape", "lfo2Shape" };
+const juce::String lfoShapeNames[numLfos]  = { "LFO 1 Shape", "LFO 2 Shape" };
+
+const juce::String modSourceIDs[numModSlots]    = { "mod1Source", "mod2Source", "mod3Source", "mod4Source" };
+const juce::String modSourceNames[numModSlots]  = { "Mod 1 Source", "Mod 2 Source", "Mod 3 Source", "Mod 4 Source" };
+const juce::String modTargetIDs[numModSlots]    = { "mod1Target", "mod2Target", "mod3Target", "mod4Target" };
+const juce::String modTargetNames[numModSlots]  = { "Mod 1 Target", "Mod 2 Target", "Mod 3 Target", "Mod 4 Target" };
+const juce::String modDepthIDs[numModSlots]     = { "mod1Depth", "mod2Depth", "mod3Depth", "mod4Depth" };
+const juce::String modDepthNames[numModSlots]   = { "Mod 1 Depth", "Mod 2 Depth", "Mod 3 Depth", "Mod 4 Depth" };
+
+const juce::Identifier neuralModelPathID      = "neuralModelPath";
+const juce::Identifier impulseResponsePathID  = "impulseResponsePath";
+
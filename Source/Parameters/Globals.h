@@ -1,30 +1,140 @@
-/*
-  ==============================================================================
-
-    Globals.h
-    Created: 12 Mar 2023 12:37:13pm
-    Author:  Alperen Kurbetci
-
-  ==============================================================================
-*/
-
-#pragma once
-#include <JuceHeader.h>
-
-extern const juce::String disModelID;
-extern const juce::String disModelName;
-
-extern const juce::String inputID;
-extern const juce::String inputName;
-
-
-extern const juce::String outputID;
-extern const juce::String outputName;
-
-
-extern const juce::String mixID;
-extern const juce::String mixName;
-
-
-
-extern float MaxVal;
+/*
+  ==============================================================================
+
+    Globals.h
+    Created: 12 Mar 2023 12:37:13pm
+    Author:  Alperen Kurbetci
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+extern const juce::String disModelID;
+extern const juce::String disModelName;
+
+extern const juce::String inputID;
+extern const juce::String inputName;
+
+
+extern const juce::String outputID;
+extern const juce::String outputName;
+
+
+extern const juce::String mixID;
+extern const juce::String mixName;
+
+
+extern const juce::String cabinetID;
+extern const juce::String cabinetName;
+
+
+extern const juce::String limiterID;
+extern const juce::String limiterName;
+
+
+extern const juce::String ceilingID;
+extern const juce::String ceilingName;
+
+
+extern const juce::String autoGainID;
+extern const juce::String autoGainName;
+
+
+extern const juce::String stereoModeID;
+extern const juce::String stereoModeName;
+
+
+//Second lane: right channel in dual mono, side in mid-side
+extern const juce::String disModel2ID;
+extern const juce::String disModel2Name;
+
+extern const juce::String input2ID;
+extern const juce::String input2Name;
+
+extern const juce::String mix2ID;
+extern const juce::String mix2Name;
+
+
+//Sidechain depth, how far the sidechain level moves drive and mix
+extern const juce::String sidechainDriveID;
+extern const juce::String sidechainDriveName;
+
+extern const juce::String sidechainMixID;
+extern const juce::String sidechainMixName;
+
+
+//Second model the lanes crossfade to
+extern const juce::String blendModelID;
+extern const juce::String blendModelName;
+
+extern const juce::String blendID;
+extern const juce::String blendName;
+
+
+//Tape model: bias, saturation and the solver of the hysteresis
+extern const juce::String tapeBiasID;
+extern const juce::String tapeBiasName;
+
+extern const juce::String tapeSaturationID;
+extern const juce::String tapeSaturationName;
+
+extern const juce::String tapeSolverID;
+extern const juce::String tapeSolverName;
+
+extern const juce::String foldShapeID;
+extern const juce::String foldShapeName;
+
+extern const juce::String shaperBiasID;
+extern const juce::String shaperBiasName;
+
+
+//Host bypass, returned from getBypassParameter()
+extern const juce::String bypassID;
+extern const juce::String bypassName;
+
+
+//Harmonic designer: the level of harmonics 2 - 8 relative to the fundamental
+constexpr int numHarmonicLevels = 7;
+
+extern const juce::String harmonicIDs[numHarmonicLevels];
+extern const juce::String harmonicNames[numHarmonicLevels];
+
+
+//Cascade: the number of stages, then model, drive and tone of the stages after the first
+constexpr int numExtraStages = 3;
+
+extern const juce::String numStagesID;
+extern const juce::String numStagesName;
+
+extern const juce::String stageModelIDs[numExtraStages];
+extern const juce::String stageModelNames[numExtraStages];
+extern const juce::String stageDriveIDs[numExtraStages];
+extern const juce::String stageDriveNames[numExtraStages];
+extern const juce::String stageToneIDs[numExtraStages];
+extern const juce::String stageToneNames[numExtraStages];
+
+
+//Modulation: LFO settings and the routing slots (source, target, depth)
+constexpr int numLfos = 2;
+constexpr int numModSlots = 4;
+
+extern const juce::String lfoRateIDs[numLfos];
+extern const juce::String lfoRateNames[numLfos];
+extern const juce::String lfoShapeIDs[numLfos];
+extern const juce::String lfoShapeNames[numLfos];
+
+extern const juce::String modSourceIDs[numModSlots];
+extern const juce::String modSourceNames[numModSlots];
+extern const juce::String modTargetIDs[numModSlots];
+extern const juce::String modTargetNames[numModSlots];
+extern const juce::String modDepthIDs[numModSlots];
+extern const juce::String modDepthNames[numModSlots];
+
+
+
+//State properties (not automatable)
+extern const juce::Identifier neuralModelPathID;
+extern const juce::Identifier impulseResponsePathID;
+
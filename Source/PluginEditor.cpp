@@ -1,40 +1,93 @@
-/*
-  ==============================================================================
-
-    This file contains the basic framework code for a JUCE plugin editor.
-
-  ==============================================================================
-*/
-
-#include "PluginProcessor.h"
-#include "PluginEditor.h"
-
-//==============================================================================
-BuzzBoxAudioProcessorEditor::BuzzBoxAudioProcessorEditor (BuzzBoxAudioProcessor& p)
-    : AudioProcessorEditor (&p), audioProcessor (p)
-{
-    // Make sure that before the constructor has finished, you've set the
-    // editor's size to whatever you need it to be.
-    setSize (400, 300);
-}
-
-BuzzBoxAudioProcessorEditor::~BuzzBoxAudioProcessorEditor()
-{
-}
-
-//==============================================================================
-void BuzzBoxAudioProcessorEditor::paint (juce::Graphics& g)
-{
-    // (Our component is opaque, so we must completely fill the background with a solid colour)
-    g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
-
-    g.setColour (juce::Colours::white);
-    g.setFont (15.0f);
-    g.drawFittedText ("Buzz Box", getLocalBounds(), juce::Justification::centred, 1);
-}
-
-void BuzzBoxAudioProcessorEditor::resized()
-{
-    // This is generally where you'll want to lay out the positions of any
-    // subcomponents in your editor..
-}
+/*
+  ==============================================================================
+
+    This file contains the basic framework code for a JUCE plugin editor.
+
+  ==============================================================================
+*/
+
+#include "PluginProcessor.h"
+#include "PluginEditor.h"
+
+//==============================================================================
+BuzzBoxAudioProcessorEditor::BuzzBoxAudioProcessorEditor (BuzzBoxAudioProcessor& p)
+    : AudioProcessorEditor (&p), audioProcessor (p), genericEditor (p)
+{
+    addAndMakeVisible (genericEditor);
+    
+    loadModelButton.onClick = [this]
+    {
+        chooseFile ("Load a neural capture", "*.json", [this] (const juce::File& file) { audioProcessor.loadNeuralModel (file); });
+    };
+    
+    loadImpulseButton.onClick = [this]
+    {
+        chooseFile ("Load a cabinet impulse response", "*.wav;*.aif;*.aiff;*.flac",
+                    [this] (const juce::File& file) { audioProcessor.loadImpulseResponse (file); });
+    };
+    
+    addAndMakeVisible (loadModelButton);
+    addAndMakeVisible (modelStatusLabel);
+    addAndMakeVisible (loadImpulseButton);
+    addAndMakeVisible (impulseStatusLabel);
+    addAndMakeVisible (memoryLabel);
+    
+    //Loading happens on a background thread, so the status is polled
+    timerCallback();
+    startTimerHz (4);
+    
+    // Make sure that before the constructor has finished, you've set the
+    // editor's size to whatever you need it to be.
+    setSize (400, genericEditor.getHeight() + 3 * rowHeight);
+}
+
+BuzzBoxAudioProcessorEditor::~BuzzBoxAudioProcessorEditor()
+{
+    stopTimer();
+}
+
+void BuzzBoxAudioProcessorEditor::timerCallback()
+{
+    modelStatusLabel.setText (audioProcessor.getNeuralModelStatus(), juce::dontSendNotification);
+    impulseStatusLabel.setText (audioProcessor.getImpulseResponseStatus(), juce::dontSendNotification);
+    memoryLabel.setText (audioProcessor.getMemoryFootprintStatus(), juce::dontSendNotification);
+}
+
+void BuzzBoxAudioProcessorEditor::chooseFile (const juce::String& title, const juce::String& patterns,
+                                              std::function<void (const juce::File&)> onChosen)
+{
+    fileChooser = std::make_unique<juce::FileChooser> (title, juce::File(), patterns);
+    
+    fileChooser->launchAsync (juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                              [onChosen] (const juce::FileChooser& chooser)
+                              {
+                                  auto file = chooser.getResult();
+                                  
+                                  if (file.existsAsFile())
+                                      onChosen (file);
+                              });
+}
+
+//==============================================================================
+void BuzzBoxAudioProcessorEditor::paint (juce::Graphics& g)
+{
+    // (Our component is opaque, so we must completely fill the background with a solid colour)
+    g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
+}
+
+void BuzzBoxAudioProcessorEditor::resized()
+{
+    auto bounds = getLocalBounds();
+    
+    memoryLabel.setBounds (bounds.removeFromBottom (rowHeight).reduced (4));
+    
+    auto impulseRow = bounds.removeFromBottom (rowHeight).reduced (4);
+    loadImpulseButton.setBounds (impulseRow.removeFromLeft (120));
+    impulseStatusLabel.setBounds (impulseRow);
+    
+    auto modelRow = bounds.removeFromBottom (rowHeight).reduced (4);
+    loadModelButton.setBounds (modelRow.removeFromLeft (120));
+    modelStatusLabel.setBounds (modelRow);
+    
+    genericEditor.setBounds (bounds);
+}
@@ -1,33 +1,51 @@
-/*
-  ==============================================================================
-
-    This file contains the basic framework code for a JUCE plugin editor.
-
-  ==============================================================================
-*/
-
-#pragma once
-
-#include <JuceHeader.h>
-#include "PluginProcessor.h"
-
-//==============================================================================
-/**
-*/
-class BuzzBoxAudioProcessorEditor  : public juce::AudioProcessorEditor
-{
-public:
-    BuzzBoxAudioProcessorEditor (BuzzBoxAudioProcessor&);
-    ~BuzzBoxAudioProcessorEditor() override;
-
-    //==============================================================================
-    void paint (juce::Graphics&) override;
-    void resized() override;
-
-private:
-    // This reference is provided as a quick way for your editor to
-    // access the processor object that created it.
-    BuzzBoxAudioProcessor& audioProcessor;
-
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BuzzBoxAudioProcessorEditor)
-};
+/*
+  ==============================================================================
+
+    This file contains the basic framework code for a JUCE plugin editor.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+//==============================================================================
+/**
+*/
+class BuzzBoxAudioProcessorEditor  : public juce::AudioProcessorEditor, private juce::Timer
+{
+public:
+    BuzzBoxAudioProcessorEditor (BuzzBoxAudioProcessor&);
+    ~BuzzBoxAudioProcessorEditor() override;
+
+    //==============================================================================
+    void paint (juce::Graphics&) override;
+    void resized() override;
+
+private:
+    void timerCallback() override;
+    void chooseFile (const juce::String& title, const juce::String& patterns, std::function<void (const juce::File&)> onChosen);
+    
+    // This reference is provided as a quick way for your editor to
+    // access the processor object that created it.
+    BuzzBoxAudioProcessor& audioProcessor;
+    
+    //Parameters are still drawn by JUCE, the rows below are for things loaded from disk and the memory report
+    juce::GenericAudioProcessorEditor genericEditor;
+    
+    juce::TextButton loadModelButton { "Load Model..." };
+    juce::Label modelStatusLabel;
+    
+    juce::TextButton loadImpulseButton { "Load IR..." };
+    juce::Label impulseStatusLabel;
+    
+    juce::Label memoryLabel;
+    
+    std::unique_ptr<juce::FileChooser> fileChooser;
+    
+    static constexpr int rowHeight = 32;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BuzzBoxAudioProcessorEditor)
+};
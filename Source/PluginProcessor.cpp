@@ -1,252 +1,957 @@
-/*
-  ==============================================================================
-
-    Alp Kurbetci
-
-  ==============================================================================
-*/
-
-#include "PluginProcessor.h"
-#include "PluginEditor.h"
-
-//==============================================================================
-BuzzBoxAudioProcessor::BuzzBoxAudioProcessor()
-#ifndef JucePlugin_PreferredChannelConfigurations
-     : AudioProcessor (BusesProperties()
-                     #if ! JucePlugin_IsMidiEffect
-                      #if ! JucePlugin_IsSynth
-                       .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
-                      #endif
-                       .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
-                     #endif
-                       )
-, _treeState(*this, nullptr, "PARAMETERS", createParameterLayout())
-#endif
-{
-    _treeState.addParameterListener(disModelID, this);
-    _treeState.addParameterListener(inputID, this);
-    _treeState.addParameterListener(outputID, this);
-    _treeState.addParameterListener(mixID, this);
-}
-
-BuzzBoxAudioProcessor::~BuzzBoxAudioProcessor()
-{
-    _treeState.removeParameterListener(disModelID, this);
-    _treeState.removeParameterListener(inputID, this);
-    _treeState.removeParameterListener(outputID, this);
-    _treeState.removeParameterListener(mixID, this);
-}
-
-juce::AudioProcessorValueTreeState::ParameterLayout BuzzBoxAudioProcessor::createParameterLayout()
-
-{
-    std::vector <std::unique_ptr<juce::RangedAudioParameter>> params;
-    
-   //An array to choose between dist modes
-    juce::StringArray disMods = {"Hard", "Soft", "Saturation"};
-    
-  //Parameter-Choice For Dist Model Choices
-    auto DriveModel = std::make_unique<juce::AudioParameterChoice>(disModelID,disModelName,disMods,0);
-  
-  //Parameters for basic contols
-    auto paramDrive = std::make_unique<juce::AudioParameterFloat>(inputID, inputName, 0.0f, 24.0f, 0.0f);
-    auto paramOutput = std::make_unique<juce::AudioParameterFloat>(outputID, outputName, -24.0f, 24.0f, 0.0f);
-    auto paramMix= std::make_unique<juce::AudioParameterFloat>(mixID, mixName, 0.0f, 1.0f, 1.0f);
-    
-  
-  //Push the parameters 
-    params.push_back(std::move(DriveModel));
-    params.push_back(std::move(paramDrive));
-    params.push_back(std::move(paramOutput));
-    params.push_back(std::move(paramMix));
-    
-    return {params.begin(), params.end()};
-}
-
-void BuzzBoxAudioProcessor::parameterChanged(const juce::String &parameterID, float newValue)
-
-{
-    updateParameters();
-    
-}
-
-void BuzzBoxAudioProcessor::updateParameters()
-{
-  //Static cast since we model choices as int values
-    auto model = static_cast<int>(_treeState.getRawParameterValue(disModelID)->load());
-    switch (model)
-    {
-        case 0: _myDistortion.setDistortionModel(Distortion<float>::DistortionModel::cHard); break;
-        case 1: _myDistortion.setDistortionModel(Distortion<float>::DistortionModel::cSoft); break;
-        case 2: _myDistortion.setDistortionModel(Distortion<float>::DistortionModel::cSaturation); break;
-            
-    }
-        
-        
-    _myDistortion.setDrive(_treeState.getRawParameterValue(inputID) -> load());
-    _myDistortion.setMix(_treeState.getRawParameterValue(mixID) -> load());
-    _myDistortion.setOutput(_treeState.getRawParameterValue(outputID) -> load());
-    
-}
-
-//==============================================================================
-const juce::String BuzzBoxAudioProcessor::getName() const
-{
-    return JucePlugin_Name;
-}
-
-bool BuzzBoxAudioProcessor::acceptsMidi() const
-{
-   #if JucePlugin_WantsMidiInput
-    return true;
-   #else
-    return false;
-   #endif
-}
-
-bool BuzzBoxAudioProcessor::producesMidi() const
-{
-   #if JucePlugin_ProducesMidiOutput
-    return true;
-   #else
-    return false;
-   #endif
-}
-
-bool BuzzBoxAudioProcessor::isMidiEffect() const
-{
-   #if JucePlugin_IsMidiEffect
-    return true;
-   #else
-    return false;
-   #endif
-}
-
-double BuzzBoxAudioProcessor::getTailLengthSeconds() const
-{
-    return 0.0;
-}
-
-int BuzzBoxAudioProcessor::getNumPrograms()
-{
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
-}
-
-int BuzzBoxAudioProcessor::getCurrentProgram()
-{
-    return 0;
-}
-
-void BuzzBoxAudioProcessor::setCurrentProgram (int index)
-{
-}
-
-const juce::String BuzzBoxAudioProcessor::getProgramName (int index)
-{
-    return {};
-}
-
-void BuzzBoxAudioProcessor::changeProgramName (int index, const juce::String& newName)
-{
-}
-
-//==============================================================================
-void BuzzBoxAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
-{
-    
-    juce::dsp::ProcessSpec spec;
-    spec.maximumBlockSize = samplesPerBlock;
-    spec.sampleRate = sampleRate;
-    spec.numChannels = getTotalNumOutputChannels();
-    
-    _myDistortion.prepare(spec);
-    
-    updateParameters();
-}
-
-void BuzzBoxAudioProcessor::releaseResources()
-{
-    // When playback stops, you can use this as an opportunity to free up any
-    // spare memory, etc.
-}
-
-#ifndef JucePlugin_PreferredChannelConfigurations
-bool BuzzBoxAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
-{
-  #if JucePlugin_IsMidiEffect
-    juce::ignoreUnused (layouts);
-    return true;
-  #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
-        return false;
-
-    // This checks if the input layout matches the output layout
-   #if ! JucePlugin_IsSynth
-    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
-        return false;
-   #endif
-
-    return true;
-  #endif
-}
-#endif
-
-void BuzzBoxAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
-{
-    
-    const int numSamples = buffer.getNumSamples();
-    MaxVal = buffer.getMagnitude(0, numSamples);
-    juce::ScopedNoDenormals noDenormals;
-    auto totalNumInputChannels  = getTotalNumInputChannels();
-    auto totalNumOutputChannels = getTotalNumOutputChannels();
-
-    
-    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
-        buffer.clear (i, 0, buffer.getNumSamples());
-    
-    juce::dsp::AudioBlock<float> block {buffer};
-  
-  //Passing the Samples into the Distortion object
-    _myDistortion.process(juce::dsp::ProcessContextReplacing<float>(block));
-
-}
-
-//==============================================================================
-bool BuzzBoxAudioProcessor::hasEditor() const
-{
-    return true; // (change this to false if you choose to not supply an editor)
-}
-
-juce::AudioProcessorEditor* BuzzBoxAudioProcessor::createEditor()
-{
-        //    return new BuzzBoxAudioProcessorEditor (*this);
-    return new juce::GenericAudioProcessorEditor(*this);
-    
-}
-
-//==============================================================================
-void BuzzBoxAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
-{
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
-}
-
-void BuzzBoxAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
-{
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
-}
-
-//==============================================================================
-// This creates new instances of the plugin..
-juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
-{
-    return new BuzzBoxAudioProcessor();
-}
+/*
+  ==============================================================================
+
+    Alp Kurbetci
+
+  ==============================================================================
+*/
+
+#include "PluginProcessor.h"
+#include "PluginEditor.h"
+
+//==============================================================================
+BuzzBoxAudioProcessor::BuzzBoxAudioProcessor()
+#ifndef JucePlugin_PreferredChannelConfigurations
+     : AudioProcessor (BusesProperties()
+                     #if ! JucePlugin_IsMidiEffect
+                      #if ! JucePlugin_IsSynth
+                       .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                       .withInput  ("Sidechain", juce::AudioChannelSet::stereo(), false)
+                      #endif
+                       .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
+                     #endif
+                       )
+, _treeState(*this, nullptr, "PARAMETERS", createParameterLayout())
+#endif
+, _neuralLoader("BuzzBox Model Loader", SharedNeuralNetwork::createFromFile)
+{
+  //Read on the audio thread, no listener
+    _bypass = dynamic_cast<juce::AudioParameterBool*>(_treeState.getParameter(bypassID));
+    jassert (_bypass != nullptr);
+    
+  //Each parameter flags the groups it feeds, the audio thread reads them (see applyParameterChanges())
+    listenTo(disModelID, cDistortionLanes);
+    listenTo(inputID, cDistortionLanes);
+    listenTo(mixID, cDistortionLanes);
+    listenTo(disModel2ID, cDistortionLanes);
+    listenTo(input2ID, cDistortionLanes);
+    listenTo(mix2ID, cDistortionLanes);
+    listenTo(stereoModeID, cDistortionLanes);
+    listenTo(blendModelID, cDistortionLanes);
+    listenTo(blendID, cDistortionLanes);
+    listenTo(tapeBiasID, cDistortionShapers);
+    listenTo(tapeSaturationID, cDistortionShapers);
+    listenTo(tapeSolverID, cDistortionShapers);
+    listenTo(foldShapeID, cDistortionShapers);
+    listenTo(shaperBiasID, cDistortionShapers);
+    listenTo(outputID, cDistortionOutput);
+    listenTo(autoGainID, cDistortionOutput);
+    listenTo(limiterID, cDistortionOutput | cLimiter);
+    listenTo(ceilingID, cLimiter);
+    listenTo(cabinetID, cCabinet);
+    listenTo(sidechainDriveID, cModulation);
+    listenTo(sidechainMixID, cModulation);
+    
+    for (int i = 0; i < numHarmonicLevels; ++i)
+        listenTo(harmonicIDs[i], cDistortionShapers);
+    
+    listenTo(numStagesID, cDistortionStages);
+    
+    for (int i = 0; i < numExtraStages; ++i)
+    {
+        listenTo(stageModelIDs[i], cDistortionStages);
+        listenTo(stageDriveIDs[i], cDistortionStages);
+        listenTo(stageToneIDs[i], cDistortionStages);
+    }
+    
+    for (int i = 0; i < numLfos; ++i)
+    {
+        listenTo(lfoRateIDs[i], cModulation);
+        listenTo(lfoShapeIDs[i], cModulation);
+    }
+    
+    for (int i = 0; i < numModSlots; ++i)
+    {
+        listenTo(modSourceIDs[i], cModulation);
+        listenTo(modTargetIDs[i], cModulation);
+        listenTo(modDepthIDs[i], cModulation);
+    }
+    
+    _liveDistortion.setTraceRecorder(&_trace);
+    _renderDistortion.setTraceRecorder(&_trace);
+    
+  //Opt-in from outside the host, every instance writes its own file
+    const auto traceFolder = juce::SystemStats::getEnvironmentVariable("BUZZBOX_TRACE_FOLDER", {});
+    
+    if (traceFolder.isNotEmpty() && juce::File::isAbsolutePath(traceFolder))
+    {
+        static std::atomic<int> instanceCount { 0 };
+        
+        const auto name = "BuzzBox " + juce::String(juce::SystemStats::getProcessId()) + "-" + juce::String(++instanceCount) + ".json";
+        startTracing(juce::File(traceFolder).getChildFile(name));
+    }
+}
+
+BuzzBoxAudioProcessor::~BuzzBoxAudioProcessor()
+{
+    for (const auto& parameter : _parameterGroups)
+        _treeState.removeParameterListener(parameter.first, this);
+}
+
+juce::AudioProcessorValueTreeState::ParameterLayout BuzzBoxAudioProcessor::createParameterLayout()
+
+{
+    std::vector <std::unique_ptr<juce::RangedAudioParameter>> params;
+    
+   //An array to choose between dist modes
+    juce::StringArray disMods = {"Hard", "Soft", "Saturation", "Neural", "Diode", "Tape", "Harmonics", "Fold", "Triode"};
+    
+  //Parameter-Choice For Dist Model Choices
+    auto DriveModel = std::make_unique<juce::AudioParameterChoice>(disModelID,disModelName,disMods,0);
+  
+  //Parameters for basic contols
+    auto paramDrive = std::make_unique<juce::AudioParameterFloat>(inputID, inputName, 0.0f, 24.0f, 0.0f);
+    auto paramOutput = std::make_unique<juce::AudioParameterFloat>(outputID, outputName, -24.0f, 24.0f, 0.0f);
+    auto paramMix= std::make_unique<juce::AudioParameterFloat>(mixID, mixName, 0.0f, 1.0f, 1.0f);
+    
+  //Cabinet after the shaper, off by default so older sessions sound the same
+    auto paramCabinet = std::make_unique<juce::AudioParameterBool>(cabinetID, cabinetName, false);
+    
+  //True peak limiter, off by default for the same reason
+    auto paramLimiter = std::make_unique<juce::AudioParameterBool>(limiterID, limiterName, false);
+    auto paramCeiling = std::make_unique<juce::AudioParameterFloat>(ceilingID, ceilingName, -12.0f, 0.0f, -1.0f);
+    
+  //Loudness follows the input instead of the drive, the output knob still works on top
+    auto paramAutoGain = std::make_unique<juce::AudioParameterBool>(autoGainID, autoGainName, false);
+    
+  //Stereo handling, the second set of controls is for the right (dual mono) or side (mid-side) channel
+    juce::StringArray stereoModes = {"Linked", "Dual Mono", "Mid Side"};
+    auto paramStereoMode = std::make_unique<juce::AudioParameterChoice>(stereoModeID, stereoModeName, stereoModes, 0);
+    auto DriveModel2 = std::make_unique<juce::AudioParameterChoice>(disModel2ID, disModel2Name, disMods, 0);
+    auto paramDrive2 = std::make_unique<juce::AudioParameterFloat>(input2ID, input2Name, 0.0f, 24.0f, 0.0f);
+    auto paramMix2 = std::make_unique<juce::AudioParameterFloat>(mix2ID, mix2Name, 0.0f, 1.0f, 1.0f);
+    
+  //Sidechain depth at full sidechain level, negative values duck. Zero leaves the sidechain unread
+    auto paramSidechainDrive = std::make_unique<juce::AudioParameterFloat>(sidechainDriveID, sidechainDriveName, -24.0f, 24.0f, 0.0f);
+    auto paramSidechainMix = std::make_unique<juce::AudioParameterFloat>(sidechainMixID, sidechainMixName, -1.0f, 1.0f, 0.0f);
+    
+  //Crossfade to a second model, zero keeps it from running
+    auto BlendModel = std::make_unique<juce::AudioParameterChoice>(blendModelID, blendModelName, disMods, 0);
+    auto paramBlend = std::make_unique<juce::AudioParameterFloat>(blendID, blendName, 0.0f, 1.0f, 0.0f);
+    
+  //Tape model, the drive is the lane drive. RK2 is the cheapest, Newton-Raphson the most stable at high drive and low rates
+    juce::StringArray tapeSolvers = {"RK2", "RK4", "Newton-Raphson"};
+    auto paramTapeBias = std::make_unique<juce::AudioParameterFloat>(tapeBiasID, tapeBiasName, 0.0f, 1.0f, 0.5f);
+    auto paramTapeSaturation = std::make_unique<juce::AudioParameterFloat>(tapeSaturationID, tapeSaturationName, 0.0f, 1.0f, 0.5f);
+    auto paramTapeSolver = std::make_unique<juce::AudioParameterChoice>(tapeSolverID, tapeSolverName, tapeSolvers, 0);
+    
+  //Wavefolder and triode, the bias moves both off the middle of their curve for the even harmonics
+    juce::StringArray foldShapes = {"Sine", "Triangle"};
+    auto paramFoldShape = std::make_unique<juce::AudioParameterChoice>(foldShapeID, foldShapeName, foldShapes, 0);
+    auto paramShaperBias = std::make_unique<juce::AudioParameterFloat>(shaperBiasID, shaperBiasName, -1.0f, 1.0f, 0.0f);
+    
+  
+  //Push the parameters 
+    params.push_back(std::move(DriveModel));
+    params.push_back(std::move(paramDrive));
+    params.push_back(std::move(paramOutput));
+    params.push_back(std::move(paramMix));
+    params.push_back(std::move(paramCabinet));
+    params.push_back(std::move(paramLimiter));
+    params.push_back(std::move(paramCeiling));
+    params.push_back(std::move(paramAutoGain));
+    params.push_back(std::move(paramStereoMode));
+    params.push_back(std::move(DriveModel2));
+    params.push_back(std::move(paramDrive2));
+    params.push_back(std::move(paramMix2));
+    params.push_back(std::move(paramSidechainDrive));
+    params.push_back(std::move(paramSidechainMix));
+    params.push_back(std::move(BlendModel));
+    params.push_back(std::move(paramBlend));
+    params.push_back(std::move(paramTapeBias));
+    params.push_back(std::move(paramTapeSaturation));
+    params.push_back(std::move(paramTapeSolver));
+    params.push_back(std::move(paramFoldShape));
+    params.push_back(std::move(paramShaperBias));
+    
+  //Host bypass, faded and latency compensated
+    params.push_back(std::make_unique<juce::AudioParameterBool>(bypassID, bypassName, false));
+    
+  //Harmonic designer, all off is the clean fundamental
+    for (int i = 0; i < numHarmonicLevels; ++i)
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(harmonicIDs[i], harmonicNames[i], 0.0f, 1.0f, 0.0f));
+    
+  //Cascade, one stage (the lane model alone) by default. The tone is the low-pass in front of the stage
+    params.push_back(std::make_unique<juce::AudioParameterInt>(numStagesID, numStagesName, 1, numExtraStages + 1, 1));
+    
+    for (int i = 0; i < numExtraStages; ++i)
+    {
+        params.push_back(std::make_unique<juce::AudioParameterChoice>(stageModelIDs[i], stageModelNames[i], disMods, 0));
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(stageDriveIDs[i], stageDriveNames[i], 0.0f, 24.0f, 0.0f));
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(stageToneIDs[i], stageToneNames[i], juce::NormalisableRange<float>(500.0f, 20000.0f, 0.0f, 0.3f), 8000.0f));
+    }
+    
+  //Modulation, the choices follow the ModulationMatrix enums. The depth is a share of the target's range
+    juce::StringArray lfoShapes = {"Sine", "Triangle", "Saw", "Square", "Random"};
+    juce::StringArray modSources = {"Off", "LFO 1", "LFO 2", "Envelope", "Sidechain"};
+    juce::StringArray modTargets = {"Drive", "Mix", "Output", "Blend"};
+    
+    for (int i = 0; i < numLfos; ++i)
+    {
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(lfoRateIDs[i], lfoRateNames[i], juce::NormalisableRange<float>(0.05f, 20.0f, 0.0f, 0.3f), 1.0f));
+        params.push_back(std::make_unique<juce::AudioParameterChoice>(lfoShapeIDs[i], lfoShapeNames[i], lfoShapes, 0));
+    }
+    
+    for (int i = 0; i < numModSlots; ++i)
+    {
+        params.push_back(std::make_unique<juce::AudioParameterChoice>(modSourceIDs[i], modSourceNames[i], modSources, 0));
+        params.push_back(std::make_unique<juce::AudioParameterChoice>(modTargetIDs[i], modTargetNames[i], modTargets, 0));
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(modDepthIDs[i], modDepthNames[i], -1.0f, 1.0f, 0.0f));
+    }
+    
+    return {params.begin(), params.end()};
+}
+
+void BuzzBoxAudioProcessor::listenTo (const juce::String& parameterID, juce::uint32 groups)
+{
+    _parameterGroups[parameterID] = groups;
+    _treeState.addParameterListener(parameterID, this);
+}
+
+void BuzzBoxAudioProcessor::parameterChanged(const juce::String &parameterID, float newValue)
+
+{
+  //Any thread (automation comes on the audio thread, the editor on the message thread): only flags the change
+    const auto group = _parameterGroups.find(parameterID);
+    
+    if (group != _parameterGroups.end())
+        _changedGroups.fetch_or(group->second, std::memory_order_release);
+}
+
+void BuzzBoxAudioProcessor::applyParameterChanges() noexcept
+{
+  //Each profile keeps what it has not seen yet, the one not playing catches up when it takes over
+    const auto changed = _changedGroups.exchange(0, std::memory_order_acquire);
+    
+    for (auto& pending : _profileChanges)
+        pending |= changed & distortionGroups;
+    
+    auto& pending = _profileChanges[(size_t) _profile];
+    const auto groups = (changed & ~distortionGroups) | pending;
+    pending = 0;
+    
+    if (groups != 0)
+        updateParameters(groups);
+}
+
+void BuzzBoxAudioProcessor::updateParameters (juce::uint32 groups) noexcept
+{
+    TraceRecorder::Scope span (&_trace, "Parameters");
+    
+  //Only the profile playing, with the values as they are now
+    if ((groups & distortionGroups) != 0)
+        updateDistortions(_profile, groups);
+    
+    if ((groups & cModulation) != 0)
+        updateModulation();
+    
+    if ((groups & cCabinet) != 0)
+        _cabinet.setEnabled(_treeState.getRawParameterValue(cabinetID) -> load() > 0.5f);
+    
+  //The lookahead stays in the path when the limiter is off, so the reported latency never changes here
+    if ((groups & cLimiter) != 0)
+    {
+        _limiter.setEnabled(_treeState.getRawParameterValue(limiterID) -> load() > 0.5f);
+        _limiter.setCeiling(_treeState.getRawParameterValue(ceilingID) -> load());
+    }
+}
+
+void BuzzBoxAudioProcessor::updateDistortions (QualityProfile profile, juce::uint32 groups) noexcept
+{
+    if (profile == QualityProfile::cRender)
+        _renderDistortion.forEachDistortion([this, groups] (auto& distortion) { updateDistortion(distortion, groups); });
+    else
+        _liveDistortion.forEachDistortion([this, groups] (auto& distortion) { updateDistortion(distortion, groups); });
+}
+
+void BuzzBoxAudioProcessor::updateModulation() noexcept
+{
+  //Modulation: the user slots first, then the sidechain depth controls as two fixed slots
+    static_assert(numModSlots + 2 <= ModulationMatrix::maxSlots, "Not enough modulation slots");
+    static_assert(numLfos == ModulationMatrix::numLfos, "LFO parameters do not match the matrix");
+    
+    const float targetRanges[ModulationMatrix::numDestinations] = { 24.0f, 1.0f, 24.0f, 1.0f };
+    
+    for (int i = 0; i < numModSlots; ++i)
+    {
+        const auto source = static_cast<int>(_treeState.getRawParameterValue(modSourceIDs[i]) -> load());
+        const auto target = static_cast<int>(_treeState.getRawParameterValue(modTargetIDs[i]) -> load());
+        const auto depth = _treeState.getRawParameterValue(modDepthIDs[i]) -> load();
+        
+        _modulation.setSlot(i, static_cast<ModulationMatrix::Source>(source), static_cast<ModulationMatrix::Destination>(target), depth * targetRanges[target]);
+    }
+    
+    _modulation.setSlot(numModSlots, ModulationMatrix::Source::cSidechain, ModulationMatrix::Destination::cDrive,
+                        _treeState.getRawParameterValue(sidechainDriveID) -> load());
+    _modulation.setSlot(numModSlots + 1, ModulationMatrix::Source::cSidechain, ModulationMatrix::Destination::cMix,
+                        _treeState.getRawParameterValue(sidechainMixID) -> load());
+    
+    for (int i = 0; i < numLfos; ++i)
+        _modulation.setLfo(i, _treeState.getRawParameterValue(lfoRateIDs[i]) -> load(),
+                           static_cast<ModulationMatrix::LfoShape>(static_cast<int>(_treeState.getRawParameterValue(lfoShapeIDs[i]) -> load())));
+}
+
+template <typename SampleType>
+void BuzzBoxAudioProcessor::updateDistortion (Distortion<SampleType>& distortion, juce::uint32 groups)
+{
+    if ((groups & cDistortionLanes) != 0)
+        updateDistortionLanes(distortion);
+    
+    if ((groups & cDistortionShapers) != 0)
+        updateDistortionShapers(distortion);
+    
+    if ((groups & cDistortionStages) != 0)
+        updateDistortionStages(distortion);
+    
+    if ((groups & cDistortionOutput) != 0)
+    {
+        distortion.setAutoGain(_treeState.getRawParameterValue(autoGainID) -> load() > 0.5f);
+        distortion.setOutput(_treeState.getRawParameterValue(outputID) -> load());
+        
+      //The limiter holds the ceiling, so the distortion can drop its own clamp
+        distortion.setSafetyClip(_treeState.getRawParameterValue(limiterID) -> load() <= 0.5f);
+    }
+}
+
+template <typename SampleType>
+void BuzzBoxAudioProcessor::updateDistortionLanes (Distortion<SampleType>& distortion)
+{
+  //Lane 0 takes the main controls, lane 1 the R/S ones (only heard in dual mono and mid-side)
+    const juce::String* modelIDs[] = { &disModelID, &disModel2ID };
+    const juce::String* driveIDs[] = { &inputID, &input2ID };
+    const juce::String* mixIDs[]   = { &mixID, &mix2ID };
+    
+    for (size_t lane = 0; lane < Distortion<SampleType>::numLanes; ++lane)
+    {
+        distortion.setDistortionModel(getDistortionModel<SampleType>(*modelIDs[lane]), lane);
+        distortion.setDrive(_treeState.getRawParameterValue(*driveIDs[lane]) -> load(), lane);
+        distortion.setMix(_treeState.getRawParameterValue(*mixIDs[lane]) -> load(), lane);
+    }
+    
+    switch (static_cast<int>(_treeState.getRawParameterValue(stereoModeID)->load()))
+    {
+        case 0: distortion.setStereoMode(Distortion<SampleType>::StereoMode::cLinked); break;
+        case 1: distortion.setStereoMode(Distortion<SampleType>::StereoMode::cDualMono); break;
+        case 2: distortion.setStereoMode(Distortion<SampleType>::StereoMode::cMidSide); break;
+    }
+    
+    distortion.setBlendModel(getDistortionModel<SampleType>(blendModelID));
+    distortion.setBlend(_treeState.getRawParameterValue(blendID) -> load());
+}
+
+template <typename SampleType>
+void BuzzBoxAudioProcessor::updateDistortionShapers (Distortion<SampleType>& distortion)
+{
+    distortion.setTapeBias(_treeState.getRawParameterValue(tapeBiasID) -> load());
+    distortion.setTapeSaturation(_treeState.getRawParameterValue(tapeSaturationID) -> load());
+    distortion.setTapeSolver(static_cast<typename TapeHysteresis<SampleType>::Solver>(static_cast<int>(_treeState.getRawParameterValue(tapeSolverID) -> load())));
+    
+    distortion.setFoldShape(_treeState.getRawParameterValue(foldShapeID) -> load() > 0.5f ? BiasedShaper<SampleType>::Curve::cTriangleFold
+                                                                                           : BiasedShaper<SampleType>::Curve::cSineFold);
+    distortion.setShaperBias(_treeState.getRawParameterValue(shaperBiasID) -> load());
+    
+    static_assert(numHarmonicLevels == ChebyshevShaper<SampleType>::numHarmonics, "Harmonic parameters do not match the designer");
+    
+    typename ChebyshevShaper<SampleType>::Levels harmonics;
+    
+    for (int i = 0; i < numHarmonicLevels; ++i)
+        harmonics[(size_t) i] = _treeState.getRawParameterValue(harmonicIDs[i]) -> load();
+    
+    distortion.setHarmonics(harmonics);
+}
+
+template <typename SampleType>
+void BuzzBoxAudioProcessor::updateDistortionStages (Distortion<SampleType>& distortion)
+{
+    static_assert(numExtraStages == Distortion<SampleType>::maxStages - 1, "Stage parameters do not match the cascade");
+    
+    distortion.setNumStages(static_cast<int>(_treeState.getRawParameterValue(numStagesID) -> load()));
+    
+    for (int i = 0; i < numExtraStages; ++i)
+    {
+        distortion.setStageModel((size_t) i, getDistortionModel<SampleType>(stageModelIDs[i]));
+        distortion.setStageDrive((size_t) i, _treeState.getRawParameterValue(stageDriveIDs[i]) -> load());
+        distortion.setStageTone((size_t) i, _treeState.getRawParameterValue(stageToneIDs[i]) -> load());
+    }
+}
+
+template <typename SampleType>
+typename Distortion<SampleType>::DistortionModel BuzzBoxAudioProcessor::getDistortionModel (const juce::String& parameterID) const
+{
+    using Model = typename Distortion<SampleType>::DistortionModel;
+    
+  //Static cast since we model choices as int values
+    switch (static_cast<int>(_treeState.getRawParameterValue(parameterID)->load()))
+    {
+        case 1: return Model::cSoft;
+        case 2: return Model::cSaturation;
+        case 3: return Model::cNeural;
+        case 4: return Model::cDiode;
+        case 5: return Model::cTape;
+        case 6: return Model::cHarmonics;
+        case 7: return Model::cFold;
+        case 8: return Model::cTriode;
+    }
+    
+    return Model::cHard;
+}
+
+void BuzzBoxAudioProcessor::loadNeuralModel (const juce::File& modelFile)
+{
+    _neuralLoader.loadFile(modelFile);
+}
+
+juce::String BuzzBoxAudioProcessor::getNeuralModelStatus() const
+{
+    auto error = _neuralLoader.getLastError();
+    
+    if (error.isNotEmpty())
+        return error;
+    
+    auto file = _neuralLoader.getFile();
+    return file == juce::File() ? juce::String("No model loaded") : file.getFileName();
+}
+
+void BuzzBoxAudioProcessor::loadImpulseResponse (const juce::File& irFile)
+{
+    _cabinet.loadImpulseResponse(irFile);
+}
+
+juce::String BuzzBoxAudioProcessor::getImpulseResponseStatus() const
+{
+    auto error = _cabinet.getLastError();
+    
+    if (error.isNotEmpty())
+        return error;
+    
+    auto file = _cabinet.getImpulseResponseFile();
+    
+    if (file == juce::File())
+        return "No impulse response loaded";
+    
+    const auto overruns = _cabinet.getNumTailOverruns();
+    return overruns > 0 ? file.getFileName() + " (" + juce::String(overruns) + " late tail blocks)" : file.getFileName();
+}
+
+BuzzBoxAudioProcessor::MemoryFootprint BuzzBoxAudioProcessor::getMemoryFootprint() const
+{
+    //Every part counts its own size as well, which sizeof (*this) already holds
+    MemoryFootprint footprint;
+    footprint.instanceBytes = sizeof (*this)
+                            + _liveDistortion.getMemoryFootprintBytes() - sizeof (_liveDistortion)
+                            + _renderDistortion.getMemoryFootprintBytes() - sizeof (_renderDistortion)
+                            + _cabinet.getMemoryFootprintBytes() - sizeof (_cabinet)
+                            + _limiter.getMemoryFootprintBytes() - sizeof (_limiter)
+                            + _modulation.getMemoryFootprintBytes() - sizeof (_modulation)
+                            + _dryDelay.getSizeInBytes()
+                            + (size_t) _dry.getNumChannels() * (size_t) _dry.getNumSamples() * sizeof (float);
+    
+    footprint.sharedBytes = _sharedResources->getMemoryFootprintBytes();
+    footprint.numSharedResources = _sharedResources->getNumResources();
+    return footprint;
+}
+
+bool BuzzBoxAudioProcessor::startTracing (const juce::File& file)
+{
+    file.getParentDirectory().createDirectory();
+    return _trace.start(file);
+}
+
+void BuzzBoxAudioProcessor::stopTracing()
+{
+    _trace.stop();
+}
+
+juce::String BuzzBoxAudioProcessor::getMemoryFootprintStatus() const
+{
+    const auto footprint = getMemoryFootprint();
+    
+    return "Memory: " + juce::File::descriptionOfSizeInBytes((juce::int64) footprint.instanceBytes) + " per instance, "
+         + juce::File::descriptionOfSizeInBytes((juce::int64) footprint.sharedBytes) + " shared ("
+         + juce::String(footprint.numSharedResources) + " resources)";
+}
+
+bool BuzzBoxAudioProcessor::isLoadingFiles() const
+{
+  //Still true while a built file waits for processBlock() to pick it up
+    return _neuralLoader.isLoading() || _cabinet.isLoading();
+}
+
+juce::String BuzzBoxAudioProcessor::getLoadError() const
+{
+    auto error = _neuralLoader.getLastError();
+    
+    return error.isNotEmpty() ? error : _cabinet.getLastError();
+}
+
+//==============================================================================
+const juce::String BuzzBoxAudioProcessor::getName() const
+{
+    return JucePlugin_Name;
+}
+
+bool BuzzBoxAudioProcessor::acceptsMidi() const
+{
+   #if JucePlugin_WantsMidiInput
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+bool BuzzBoxAudioProcessor::producesMidi() const
+{
+   #if JucePlugin_ProducesMidiOutput
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+bool BuzzBoxAudioProcessor::isMidiEffect() const
+{
+   #if JucePlugin_IsMidiEffect
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+double BuzzBoxAudioProcessor::getTailLengthSeconds() const
+{
+  //The cabinet rings for as long as its impulse response
+    return _cabinet.isEnabled() ? _cabinet.getTailLengthSeconds() : 0.0;
+}
+
+int BuzzBoxAudioProcessor::getNumPrograms()
+{
+    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
+                // so this should be at least 1, even if you're not really implementing programs.
+}
+
+int BuzzBoxAudioProcessor::getCurrentProgram()
+{
+    return 0;
+}
+
+void BuzzBoxAudioProcessor::setCurrentProgram (int index)
+{
+}
+
+const juce::String BuzzBoxAudioProcessor::getProgramName (int index)
+{
+    return {};
+}
+
+void BuzzBoxAudioProcessor::changeProgramName (int index, const juce::String& newName)
+{
+}
+
+//==============================================================================
+void BuzzBoxAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
+{
+    
+  //The chain only ever sees sub-blocks, the host block size does not size anything
+    juce::ignoreUnused(samplesPerBlock);
+    
+    juce::dsp::ProcessSpec spec;
+    spec.maximumBlockSize = (juce::uint32) subBlockSize;
+    spec.sampleRate = sampleRate;
+    spec.numChannels = getTotalNumOutputChannels();
+    
+    _liveDistortion.prepare(spec, liveOversampling, juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR, false);
+    _renderDistortion.prepare(spec, renderOversampling, juce::dsp::Oversampling<double>::filterHalfBandFIREquiripple, true);
+    
+  //Only ever played offline, where the harmonic designs are built at the block that needs them
+    _renderDistortion.forEachDistortion([] (auto& distortion) { distortion.setNonRealtime(true); });
+    
+  //Padded to the longer of the two, so a switch to offline rendering keeps the delay compensation valid
+    const auto latency = juce::jmax(_liveDistortion.getOversamplingLatency(), _renderDistortion.getOversamplingLatency());
+    _liveDistortion.setLatency(latency);
+    _renderDistortion.setLatency(latency);
+    _profile = isNonRealtime() ? QualityProfile::cRender : QualityProfile::cLive;
+    
+    _cabinet.prepare(spec);
+    _limiter.prepare(spec);
+    _modulation.prepare(sampleRate, subBlockSize, _modulationInterval);
+    _subBlockPosition = 0;
+    
+  //Reported from here only, the host is told on the message thread
+    setLatencySamples(_liveDistortion.getLatency() + _limiter.getLatencySamples());
+    
+  //Dry copy for the bypass, as long as the latency of the chain
+    _dryDelayLength = getLatencySamples() + 1;
+    _dryDelay.allocate(spec.numChannels * (size_t) _dryDelayLength, true);
+    _dryDelayPosition = 0;
+    _dry.setSize((int) spec.numChannels, subBlockSize);
+    
+    _bypassFade.reset(sampleRate, 0.02);
+    _bypassFade.setCurrentAndTargetValue(_bypass->get() ? 1.0f : 0.0f);
+    _chainIdle = _bypass->get();
+    _resumeHold = 0;
+    
+  //The audio thread is not running yet, so both profiles and everything else take the current values here
+    _changedGroups.store(0);
+    _profileChanges.fill(0);
+    
+    updateDistortions(QualityProfile::cLive, allGroups);
+    updateDistortions(QualityProfile::cRender, allGroups);
+    updateParameters(allGroups & ~distortionGroups);
+}
+
+void BuzzBoxAudioProcessor::releaseResources()
+{
+    // When playback stops, you can use this as an opportunity to free up any
+    // spare memory, etc.
+}
+
+#ifndef JucePlugin_PreferredChannelConfigurations
+bool BuzzBoxAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
+{
+  #if JucePlugin_IsMidiEffect
+    juce::ignoreUnused (layouts);
+    return true;
+  #else
+    // This is the place where you check if the layout is supported.
+    // In this template code we only support mono or stereo.
+    // Some plugin hosts, such as certain GarageBand versions, will only
+    // load plugins that support stereo bus layouts.
+    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
+     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+        return false;
+
+    // This checks if the input layout matches the output layout
+   #if ! JucePlugin_IsSynth
+    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
+        return false;
+
+    // The sidechain may be off, mono or stereo
+    if (layouts.inputBuses.size() > 1)
+    {
+        const auto sidechain = layouts.getChannelSet (true, 1);
+
+        if (! sidechain.isDisabled()
+         && sidechain != juce::AudioChannelSet::mono()
+         && sidechain != juce::AudioChannelSet::stereo())
+            return false;
+    }
+   #endif
+
+    return true;
+  #endif
+}
+#endif
+
+void BuzzBoxAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processBuffer(buffer, _bypass->get());
+}
+
+void BuzzBoxAudioProcessor::processBlockBypassed (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+  //Hosts that bypass without the parameter get the same fade and the latency they were told about
+    processBuffer(buffer, true);
+}
+
+juce::AudioProcessorParameter* BuzzBoxAudioProcessor::getBypassParameter() const
+{
+    return _bypass;
+}
+
+void BuzzBoxAudioProcessor::processBuffer (juce::AudioBuffer<float>& buffer, bool bypassed) noexcept
+{
+    TraceRecorder::Scope span (&_trace, "processBlock");
+    
+    const int numSamples = buffer.getNumSamples();
+    juce::ScopedNoDenormals noDenormals;
+  //Only the main bus is processed, the sidechain channels sit behind it in the buffer
+    auto mainBuffer = getBusBuffer(buffer, false, 0);
+    auto mainInputChannels  = getMainBusNumInputChannels();
+    auto mainOutputChannels = getMainBusNumOutputChannels();
+
+    
+    for (auto i = mainInputChannels; i < mainOutputChannels; ++i)
+        mainBuffer.clear (i, 0, numSamples);
+    
+  //A NaN or Inf from the host would stay in every filter state after it, nothing reads the input before this
+    for (int channel = 0; channel < getTotalNumInputChannels(); ++channel)
+        sanitiseInput(buffer.getWritePointer(channel), numSamples);
+    
+    //Picks up a newly loaded capture, lock free
+    const auto* model = _neuralLoader.acquire();
+    const auto* network = model != nullptr ? model->get() : nullptr;
+    _liveDistortion.setNeuralNetwork(network);
+    _renderDistortion.setNeuralNetwork(network);
+    
+  //The host may start or stop a bounce without preparing again, the profile coming in starts from a clean state
+    const auto profile = isNonRealtime() ? QualityProfile::cRender : QualityProfile::cLive;
+    const auto profileChanged = profile != _profile;
+    _profile = profile;
+    
+  //The one writer of every parameter, before the reset so the profile coming in starts on the current values
+    applyParameterChanges();
+    
+    if (profileChanged)
+    {
+        if (profile == QualityProfile::cRender)
+            _renderDistortion.reset();
+        else
+            _liveDistortion.reset();
+    }
+    
+  //A bounce may compute a late cabinet tail in place, real time plays it without
+    _cabinet.setNonRealtime(profile == QualityProfile::cRender);
+    
+    _bypassFade.setTargetValue(bypassed ? 1.0f : 0.0f);
+    
+  //Modulation reads the sidechain, it has no channels when it is off
+    auto sidechainBuffer = getBusCount(true) > 1 ? getBusBuffer(buffer, true, 1) : juce::AudioBuffer<float>();
+    
+  //Sub-blocks on the fixed grid, whatever the host block size (more than announced in prepareToPlay() included)
+    for (int start = 0; start < numSamples;)
+    {
+        const auto count = juce::jmin(subBlockSize - _subBlockPosition, numSamples - start);
+        
+        juce::AudioBuffer<float> mainSection (mainBuffer.getArrayOfWritePointers(), mainBuffer.getNumChannels(), start, count);
+        juce::AudioBuffer<float> sidechainSection (sidechainBuffer.getArrayOfWritePointers(), sidechainBuffer.getNumChannels(), start, count);
+        
+        processSection(mainSection, sidechainSection, mainInputChannels);
+        
+        start += count;
+        _subBlockPosition = (_subBlockPosition + count) % subBlockSize;
+    }
+}
+
+void BuzzBoxAudioProcessor::processSection (juce::AudioBuffer<float>& mainBuffer, juce::AudioBuffer<float>& sidechainBuffer, int numInputChannels) noexcept
+{
+    const auto numSamples = mainBuffer.getNumSamples();
+    const auto numChannels = juce::jmin(mainBuffer.getNumChannels(), _dry.getNumChannels());
+    const auto fullyBypassed = _bypassFade.getTargetValue() > 0.5f && ! _bypassFade.isSmoothing();
+    
+  //Nothing to line up, the input already is the output
+    if (fullyBypassed && getLatencySamples() == 0)
+    {
+        _chainIdle = true;
+        return;
+    }
+    
+  //Always written, so the dry copy has its history the moment the bypass starts
+    delayDry(mainBuffer, numChannels);
+    
+    if (fullyBypassed)
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+            mainBuffer.copyFrom(channel, 0, _dry, channel, 0, numSamples);
+        
+        _chainIdle = true;
+        return;
+    }
+    
+  //Back from a full bypass: the chain starts over and stays dry until its first output is through
+    if (_chainIdle)
+    {
+        resetChain();
+        _chainIdle = false;
+        _resumeHold = getLatencySamples();
+    }
+    
+    processSubBlock(mainBuffer, sidechainBuffer, numInputChannels);
+    
+    if (_resumeHold == 0 && ! _bypassFade.isSmoothing() && _bypassFade.getCurrentValue() == 0.0f)
+        return;
+    
+    float dryGains[subBlockSize];
+    
+    for (int i = 0; i < numSamples; ++i)
+    {
+        if (_resumeHold > 0)
+        {
+            --_resumeHold;
+            dryGains[i] = 1.0f;
+        }
+        else
+        {
+            dryGains[i] = _bypassFade.getNextValue();
+        }
+    }
+    
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* wet = mainBuffer.getWritePointer(channel);
+        const auto* dry = _dry.getReadPointer(channel);
+        
+        for (int i = 0; i < numSamples; ++i)
+            wet[i] += dryGains[i] * (dry[i] - wet[i]);
+    }
+}
+
+void BuzzBoxAudioProcessor::delayDry (const juce::AudioBuffer<float>& input, int numChannels) noexcept
+{
+    const auto numSamples = input.getNumSamples();
+    const auto delaySamples = juce::jmin(getLatencySamples(), _dryDelayLength - 1);
+    
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* ring = _dryDelay.get() + (size_t) channel * (size_t) _dryDelayLength;
+        const auto* samples = input.getReadPointer(channel);
+        auto* dry = _dry.getWritePointer(channel);
+        
+        auto write = _dryDelayPosition;
+        auto read = write - delaySamples;
+        
+        if (read < 0)
+            read += _dryDelayLength;
+        
+        for (int i = 0; i < numSamples; ++i)
+        {
+            ring[write] = samples[i];
+            dry[i] = ring[read];
+            
+            if (++write == _dryDelayLength)
+                write = 0;
+            
+            if (++read == _dryDelayLength)
+                read = 0;
+        }
+    }
+    
+    _dryDelayPosition = (_dryDelayPosition + numSamples) % _dryDelayLength;
+}
+
+void BuzzBoxAudioProcessor::resetChain() noexcept
+{
+    if (_profile == QualityProfile::cRender)
+        _renderDistortion.reset();
+    else
+        _liveDistortion.reset();
+    
+    _cabinet.reset();
+    _limiter.reset();
+    _modulation.reset();
+}
+
+void BuzzBoxAudioProcessor::processSubBlock (juce::AudioBuffer<float>& mainBuffer, juce::AudioBuffer<float>& sidechainBuffer, int numInputChannels) noexcept
+{
+    const auto numSamples = mainBuffer.getNumSamples();
+    
+  //Modulation reads the dry input, the distortion gets it for this sub-block only
+    const auto modulation = [&]
+    {
+        TraceRecorder::Scope modulationSpan (&_trace, "Modulation");
+        
+        return _modulation.process(mainBuffer.getArrayOfReadPointers(), juce::jmin(numInputChannels, mainBuffer.getNumChannels()),
+                                   sidechainBuffer.getArrayOfReadPointers(), sidechainBuffer.getNumChannels(), numSamples);
+    }();
+    
+    juce::dsp::AudioBlock<float> block {mainBuffer};
+  
+  //Passing the Samples into the Distortion object
+    {
+        TraceRecorder::Scope distortionSpan (&_trace, "Distortion");
+        
+        if (_profile == QualityProfile::cRender)
+        {
+            _renderDistortion.setModulation(modulation);
+            _renderDistortion.process(block);
+        }
+        else
+        {
+            _liveDistortion.setModulation(modulation);
+            _liveDistortion.process(block);
+        }
+    }
+    
+  //Cabinet after the shaper (does nothing when switched off or nothing is loaded)
+    {
+        TraceRecorder::Scope cabinetSpan (&_trace, "Cabinet");
+        _cabinet.process(juce::dsp::ProcessContextReplacing<float>(block));
+    }
+    
+  //Ceiling for the whole chain, inter-sample peaks included
+    {
+        TraceRecorder::Scope limiterSpan (&_trace, "Limiter");
+        _limiter.process(juce::dsp::ProcessContextReplacing<float>(block));
+    }
+}
+
+void BuzzBoxAudioProcessor::sanitiseInput (float* samples, int numSamples) noexcept
+{
+  //x - x is 0 for every finite x and NaN otherwise, unlike isfinite() this loop vectorises
+    auto check = 0.0f;
+    
+    for (int i = 0; i < numSamples; ++i)
+        check += samples[i] - samples[i];
+    
+    if (check == 0.0f)
+        return;
+    
+    for (int i = 0; i < numSamples; ++i)
+        if (! std::isfinite(samples[i]))
+            samples[i] = 0.0f;
+}
+
+//==============================================================================
+bool BuzzBoxAudioProcessor::hasEditor() const
+{
+    return true; // (change this to false if you choose to not supply an editor)
+}
+
+juce::AudioProcessorEditor* BuzzBoxAudioProcessor::createEditor()
+{
+    return new BuzzBoxAudioProcessorEditor (*this);
+    
+}
+
+//==============================================================================
+void BuzzBoxAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
+{
+  //Parameters plus the file paths of anything loaded from disk
+    auto state = _treeState.copyState();
+    state.setProperty(neuralModelPathID, _neuralLoader.getFile().getFullPathName(), nullptr);
+    state.setProperty(impulseResponsePathID, _cabinet.getImpulseResponseFile().getFullPathName(), nullptr);
+    
+    if (auto xml = state.createXml())
+        copyXmlToBinary(*xml, destData);
+}
+
+void BuzzBoxAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
+{
+    std::unique_ptr<juce::XmlElement> xml (getXmlFromBinary(data, sizeInBytes));
+    
+    if (xml == nullptr || ! xml->hasTagName(_treeState.state.getType()))
+        return;
+    
+    _treeState.replaceState(juce::ValueTree::fromXml(*xml));
+    
+  //A state saved without a capture has none, the one playing now must not carry over
+    auto modelPath = _treeState.state.getProperty(neuralModelPathID).toString();
+    
+    if (modelPath.isNotEmpty())
+        _neuralLoader.loadFile(juce::File(modelPath));
+    else if (_neuralLoader.getFile() != juce::File())
+        _neuralLoader.unload();
+    
+    auto irPath = _treeState.state.getProperty(impulseResponsePathID).toString();
+    
+    if (irPath.isNotEmpty())
+        _cabinet.loadImpulseResponse(juce::File(irPath));
+    else if (_cabinet.getImpulseResponseFile() != juce::File())
+        _cabinet.clearImpulseResponse();
+}
+
+//==============================================================================
+// This creates new instances of the plugin..
+juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
+{
+    return new BuzzBoxAudioProcessor();
+}
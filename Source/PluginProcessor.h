@@ -1,83 +1,257 @@
-/*
-  ==============================================================================
-
-   Alp Kurbetci
-
-  ==============================================================================
-*/
-
-#pragma once
-
-#include <JuceHeader.h>
-#include "DSP/Distortion.h"
-#include "Parameters/Globals.h"
-
-
-//==============================================================================
-/**
-*/
-
-//Add a listener 
-
-class BuzzBoxAudioProcessor  : public juce::AudioProcessor ,juce::AudioProcessorValueTreeState::Listener
-                            #if JucePlugin_Enable_ARA
-                             , public juce::AudioProcessorARAExtension
-                            #endif
-{
-public:
-    //==============================================================================
-    BuzzBoxAudioProcessor();
-    ~BuzzBoxAudioProcessor() override;
-
-    //==============================================================================
-    void prepareToPlay (double sampleRate, int samplesPerBlock) override;
-    void releaseResources() override;
-
-   #ifndef JucePlugin_PreferredChannelConfigurations
-    bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
-   #endif
-
-    void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
-
-    //==============================================================================
-    juce::AudioProcessorEditor* createEditor() override;
-    bool hasEditor() const override;
-
-    //==============================================================================
-    const juce::String getName() const override;
-
-    bool acceptsMidi() const override;
-    bool producesMidi() const override;
-    bool isMidiEffect() const override;
-    double getTailLengthSeconds() const override;
-
-    //==============================================================================
-    int getNumPrograms() override;
-    int getCurrentProgram() override;
-    void setCurrentProgram (int index) override;
-    const juce::String getProgramName (int index) override;
-    void changeProgramName (int index, const juce::String& newName) override;
-
-    //==============================================================================
-    void getStateInformation (juce::MemoryBlock& destData) override;
-    void setStateInformation (const void* data, int sizeInBytes) override;
-
-    juce::AudioProcessorValueTreeState _treeState;
-    
-    
-private:
-    
-    //Value Tree State Object
-    juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
-    
-    //Functions for parameter control
-    void parameterChanged (const juce::String& parameterID, float newValue) override;
-    void updateParameters();
-    
-    //Distortion Object
-    Distortion<float> _myDistortion;
-    
-    
-    //==============================================================================
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BuzzBoxAudioProcessor)
-};
+/*
+  ==============================================================================
+
+   Alp Kurbetci
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DSP/Distortion.h"
+#include "DSP/OversampledDistortion.h"
+#include "DSP/BackgroundLoader.h"
+#include "DSP/NeuralNetwork.h"
+#include "DSP/CabinetConvolution.h"
+#include "DSP/TruePeakLimiter.h"
+#include "DSP/ModulationMatrix.h"
+#include "DSP/SharedResourceCache.h"
+#include "DSP/TraceRecorder.h"
+#include "DSP/AlignedBuffer.h"
+#include "Parameters/Globals.h"
+
+
+//==============================================================================
+/**
+*/
+
+//Add a listener 
+
+class BuzzBoxAudioProcessor  : public juce::AudioProcessor ,juce::AudioProcessorValueTreeState::Listener
+                            #if JucePlugin_Enable_ARA
+                             , public juce::AudioProcessorARAExtension
+                            #endif
+{
+public:
+    //==============================================================================
+    BuzzBoxAudioProcessor();
+    ~BuzzBoxAudioProcessor() override;
+
+    //==============================================================================
+    void prepareToPlay (double sampleRate, int samplesPerBlock) override;
+    void releaseResources() override;
+
+   #ifndef JucePlugin_PreferredChannelConfigurations
+    bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
+   #endif
+
+    void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlockBypassed (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    
+    juce::AudioProcessorParameter* getBypassParameter() const override;
+
+    //==============================================================================
+    juce::AudioProcessorEditor* createEditor() override;
+    bool hasEditor() const override;
+
+    //==============================================================================
+    const juce::String getName() const override;
+
+    bool acceptsMidi() const override;
+    bool producesMidi() const override;
+    bool isMidiEffect() const override;
+    double getTailLengthSeconds() const override;
+
+    //==============================================================================
+    int getNumPrograms() override;
+    int getCurrentProgram() override;
+    void setCurrentProgram (int index) override;
+    const juce::String getProgramName (int index) override;
+    void changeProgramName (int index, const juce::String& newName) override;
+
+    //==============================================================================
+    void getStateInformation (juce::MemoryBlock& destData) override;
+    void setStateInformation (const void* data, int sizeInBytes) override;
+
+    juce::AudioProcessorValueTreeState _treeState;
+    
+    //Neural capture files are parsed on the loader thread, the current model keeps playing meanwhile
+    void loadNeuralModel (const juce::File& modelFile);
+    juce::String getNeuralModelStatus() const;
+    
+    //Cabinet impulse responses are decoded and resampled on their own loader thread
+    void loadImpulseResponse (const juce::File& irFile);
+    juce::String getImpulseResponseStatus() const;
+    
+    //Offline renderers wait on these after setStateInformation() before the first real block
+    bool isLoadingFiles() const;
+    juce::String getLoadError() const;
+    
+    //Memory this instance allocated, and what every instance in the process shares (tables, impulses, captures)
+    struct MemoryFootprint
+    {
+        size_t instanceBytes = 0;
+        size_t sharedBytes = 0;
+        int numSharedResources = 0;
+    };
+    
+    MemoryFootprint getMemoryFootprint() const;
+    juce::String getMemoryFootprintStatus() const;
+    
+    /*
+     Timeline of the audio thread as Chrome trace JSON (chrome://tracing, ui.perfetto.dev), off unless
+     started here or by the BUZZBOX_TRACE_FOLDER environment variable (one file per instance)
+     */
+    bool startTracing (const juce::File& file);
+    void stopTracing();
+    
+    //Samples between modulation control points, takes effect at the next prepareToPlay()
+    void setModulationInterval (int numSamples) noexcept { _modulationInterval = numSamples; }
+    
+    
+private:
+    
+    //Value Tree State Object
+    juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
+    
+    /*
+     Functions for parameter control. parameterChanged() runs on whichever thread set the parameter,
+     so it only flags the groups the parameter feeds. The audio thread is the one writer: once per
+     block it reads the parameters of the flagged groups and hands them to the stages.
+     */
+    enum ParameterGroup : juce::uint32
+    {
+        cDistortionLanes   = 1 << 0,
+        cDistortionShapers = 1 << 1,
+        cDistortionStages  = 1 << 2,
+        cDistortionOutput  = 1 << 3,
+        cModulation        = 1 << 4,
+        cCabinet           = 1 << 5,
+        cLimiter           = 1 << 6
+    };
+    
+    static constexpr juce::uint32 distortionGroups = cDistortionLanes | cDistortionShapers | cDistortionStages | cDistortionOutput;
+    static constexpr juce::uint32 allGroups = distortionGroups | cModulation | cCabinet | cLimiter;
+    
+    enum class QualityProfile;
+    
+    void listenTo (const juce::String& parameterID, juce::uint32 groups);
+    void parameterChanged (const juce::String& parameterID, float newValue) override;
+    void applyParameterChanges() noexcept;
+    void updateParameters (juce::uint32 groups) noexcept;
+    void updateDistortions (QualityProfile profile, juce::uint32 groups) noexcept;
+    void updateModulation() noexcept;
+    
+    template <typename SampleType>
+    void updateDistortion (Distortion<SampleType>& distortion, juce::uint32 groups);
+    
+    template <typename SampleType>
+    void updateDistortionLanes (Distortion<SampleType>& distortion);
+    
+    template <typename SampleType>
+    void updateDistortionShapers (Distortion<SampleType>& distortion);
+    
+    template <typename SampleType>
+    void updateDistortionStages (Distortion<SampleType>& distortion);
+    
+    //The groups every listened parameter feeds, filled in the constructor and only read after it
+    std::map<juce::String, juce::uint32> _parameterGroups;
+    std::atomic<juce::uint32> _changedGroups { allGroups };
+    
+    //Both entry points, the host bypass comes from the parameter or from processBlockBypassed()
+    void processBuffer (juce::AudioBuffer<float>& buffer, bool bypassed) noexcept;
+    
+    //One sub-block through the bypass crossfade, the chain only runs while it is heard
+    void processSection (juce::AudioBuffer<float>& mainBuffer, juce::AudioBuffer<float>& sidechainBuffer, int numInputChannels) noexcept;
+    
+    //The chain after the per block housekeeping, for one sub-block
+    void processSubBlock (juce::AudioBuffer<float>& mainBuffer, juce::AudioBuffer<float>& sidechainBuffer, int numInputChannels) noexcept;
+    
+    //Sets every NaN and Inf in the input to zero, a single pass when there are none
+    static void sanitiseInput (float* samples, int numSamples) noexcept;
+    
+    //Writes the input into the dry ring and fills _dry with it, delayed by the reported latency
+    void delayDry (const juce::AudioBuffer<float>& input, int numChannels) noexcept;
+    
+    //Every stage with state back to silence, after a full bypass
+    void resetChain() noexcept;
+    
+    template <typename SampleType>
+    typename Distortion<SampleType>::DistortionModel getDistortionModel (const juce::String& parameterID) const;
+    
+    /*
+     Distortion Objects, one per quality profile. Live is float with light oversampling,
+     Render (offline bounces, isNonRealtime()) is double with 16x linear phase oversampling.
+     Both are prepared up front and report the same latency, switching only resets one.
+     */
+    enum class QualityProfile
+    {
+        cLive,
+        cRender
+    };
+    
+    static constexpr size_t liveOversampling = 1;
+    static constexpr size_t renderOversampling = 4;
+    
+    OversampledDistortion<float> _liveDistortion;
+    OversampledDistortion<double> _renderDistortion;
+    QualityProfile _profile = QualityProfile::cLive;
+    
+    //Distortion groups changed since each profile last took them (audio thread), indexed by QualityProfile
+    std::array<juce::uint32, 2> _profileChanges { { allGroups, allGroups } };
+    
+    //Spans of processBlock, the parameter updates and every stage, only recorded after startTracing()
+    TraceRecorder _trace;
+    
+    //Read-only data shared with the other instances, see SharedResourceCache
+    juce::SharedResourcePointer<SharedResourceCache> _sharedResources;
+    
+    //Holds the neural capture weights, shared with every instance that loaded the same file
+    BackgroundLoader<SharedNeuralNetwork> _neuralLoader;
+    
+    //Post-shaper cabinet
+    CabinetConvolution _cabinet;
+    
+    //Optional true peak limiter at the very end
+    TruePeakLimiter<float> _limiter;
+    
+    //LFOs and envelopes routed onto drive, mix, output and blend, read once per control interval
+    ModulationMatrix _modulation;
+    int _modulationInterval = 32;
+    
+    /*
+     Host blocks (1 to thousands of samples) run through the chain in sub-blocks of at most
+     subBlockSize: every stage and every channel on one sub-block before the next, so the
+     working data stays in L1 whatever the host sends. The stages are prepared for the
+     sub-block size only. The sub-blocks sit on a fixed grid in time, a host block ending
+     inside one continues it in the next call. The smoothers run per sample, so they do not
+     depend on the host block size; what runs per call does. The modulation starts its
+     control points over at every call (point 0 where the call starts) and the auto gain
+     updates once per call, so a host block ending inside a sub-block moves them by less
+     than one control interval.
+     */
+    static constexpr int subBlockSize = 64;
+    int _subBlockPosition = 0;
+    
+    /*
+     Host bypass: the input delayed by the reported latency, crossfaded with the chain. Once
+     fully bypassed only the delay runs, or nothing at all with no latency. Coming back, every
+     stage starts from silence and is faded in once its latency has passed, so the stale state
+     from before the bypass is never heard.
+     */
+    juce::AudioParameterBool* _bypass = nullptr;
+    juce::SmoothedValue<float> _bypassFade;
+    bool _chainIdle = false;
+    int _resumeHold = 0;
+    
+  //Dry copy, one ring of _dryDelayLength per channel
+    AlignedBuffer<float> _dryDelay;
+    juce::AudioBuffer<float> _dry;
+    int _dryDelayLength = 1;
+    int _dryDelayPosition = 0;
+    
+    
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BuzzBoxAudioProcessor)
+};
@@ -0,0 +1,385 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 19 Oct 2026 5:12:30pm
+    Author:  Alperen Kurbetci
+
+    Offline fidelity measurements for the BuzzBox shapers.
+
+    For every model, drive and precision it reports
+      - THD+N and the aliasing floor over a stepped sine sweep
+      - the distortion floor of a multitone (power outside the tone bins)
+      - the difference of Distortion<float> against Distortion<double>
+      - the render cost in ns per sample
+    and compares a fixed multitone render against golden files, so CI catches numeric
+    regressions together with the performance numbers.
+
+    BuzzBoxAnalyser [--json=results.json] [--write-golden=dir] [--check-golden=dir] [--tolerance=1e-5]
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <set>
+#include "../../../Source/DSP/Distortion.h"
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int fftOrder = 15;
+    constexpr int fftSize = 1 << fftOrder;
+    constexpr int blockSize = 512;
+
+    struct ModelInfo
+    {
+        const char* name;
+        int index;
+    };
+
+    //The neural capture needs a model file, it is measured by whoever trains it
+    const ModelInfo models[] = { { "Hard", 0 }, { "Soft", 1 }, { "Saturation", 2 }, { "Diode", 4 }, { "Tape", 5 }, { "Harmonics", 6 }, { "Fold", 7 }, { "Triode", 8 } };
+    const double drives[] = { 0.0, 12.0, 24.0 };
+
+    //==============================================================================
+    /*
+     Runs a periodic signal (period fftSize) through a fresh Distortion twice and keeps the second pass,
+     so smoothers and circuit states are settled and the result is periodic too (no window needed).
+     */
+    template <typename SampleType>
+    std::vector<double> render (int modelIndex, double drive, const std::vector<double>& input, double* nanosecondsPerSample = nullptr)
+    {
+        Distortion<SampleType> distortion;
+
+        juce::dsp::ProcessSpec spec { sampleRate, (juce::uint32) blockSize, 1 };
+        distortion.prepare (spec);
+        distortion.setDistortionModel (static_cast<typename Distortion<SampleType>::DistortionModel> (modelIndex));
+        distortion.setDrive (static_cast<SampleType> (drive));
+        distortion.setMix (SampleType (1));
+        distortion.setOutput (SampleType (0));
+
+        //The harmonic designer on a fixed design up to its highest harmonic, built at the first block rather than on its thread
+        const typename ChebyshevShaper<SampleType>::Levels harmonicLevels { SampleType (0.3), SampleType (0.2), SampleType (0), SampleType (0.1),
+                                                                            SampleType (0), SampleType (0), SampleType (0.05) };
+        distortion.setNonRealtime (true);
+        distortion.setHarmonics (harmonicLevels);
+
+        const auto length = (int) input.size();
+        std::vector<SampleType> buffer ((size_t) (2 * length));
+
+        for (int i = 0; i < 2 * length; ++i)
+            buffer[(size_t) i] = static_cast<SampleType> (input[(size_t) (i % length)]);
+
+        const auto start = juce::Time::getHighResolutionTicks();
+
+        for (int offset = 0; offset < 2 * length; offset += blockSize)
+        {
+            auto* channel = buffer.data() + offset;
+            juce::dsp::AudioBlock<SampleType> block (&channel, 1, (size_t) juce::jmin (blockSize, 2 * length - offset));
+            distortion.process (juce::dsp::ProcessContextReplacing<SampleType> (block));
+        }
+
+        const auto elapsed = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start);
+
+        if (nanosecondsPerSample != nullptr)
+            *nanosecondsPerSample = 1.0e9 * elapsed / (2 * length);
+
+        return std::vector<double> (buffer.begin() + length, buffer.end());
+    }
+
+    //==============================================================================
+    ///Power per bin of one period, DC to Nyquist
+    std::vector<double> powerSpectrum (const std::vector<double>& signal)
+    {
+        juce::dsp::FFT fft (fftOrder);
+        std::vector<float> data ((size_t) (2 * fftSize), 0.0f);
+
+        for (int i = 0; i < fftSize; ++i)
+            data[(size_t) i] = (float) signal[(size_t) i];
+
+        fft.performFrequencyOnlyForwardTransform (data.data(), true);
+
+        std::vector<double> power ((size_t) (fftSize / 2 + 1));
+
+        for (size_t bin = 0; bin < power.size(); ++bin)
+            power[bin] = juce::square ((double) data[bin]);
+
+        return power;
+    }
+
+    double toDecibels (double powerRatio)
+    {
+        return 10.0 * std::log10 (juce::jmax (powerRatio, 1.0e-30));
+    }
+
+    ///Bin a harmonic lands on after folding around Nyquist
+    int foldedBin (juce::int64 bin)
+    {
+        const auto wrapped = (int) (bin % fftSize);
+        return wrapped > fftSize / 2 ? fftSize - wrapped : wrapped;
+    }
+
+    struct ToneResult
+    {
+        double thdPlusNoiseDb = 0.0;
+        double aliasingDb = 0.0;
+    };
+
+    /*
+     Single tone at an odd bin: harmonics below Nyquist are distortion, harmonics above Nyquist
+     folded back down are aliasing. Both relative to the fundamental.
+     */
+    ToneResult measureTone (const std::vector<double>& output, int toneBin)
+    {
+        const auto power = powerSpectrum (output);
+        const auto fundamental = power[(size_t) toneBin];
+
+        std::set<int> harmonicBins;
+
+        for (juce::int64 h = toneBin; h <= fftSize / 2; h += toneBin)
+            harmonicBins.insert ((int) h);
+
+        auto aliasing = 0.0;
+
+        for (juce::int64 harmonic = 2; harmonic <= 64; ++harmonic)
+        {
+            if (harmonic * toneBin <= fftSize / 2)
+                continue;
+
+            const auto bin = foldedBin (harmonic * toneBin);
+
+            if (harmonicBins.count (bin) == 0 && bin != 0)
+                aliasing += power[(size_t) bin];
+        }
+
+        auto total = 0.0;
+
+        for (size_t bin = 1; bin < power.size(); ++bin)
+            total += power[bin];
+
+        return { toDecibels ((total - fundamental) / fundamental), toDecibels (aliasing / fundamental) };
+    }
+
+    std::vector<double> makeTone (int toneBin, double amplitude)
+    {
+        std::vector<double> signal ((size_t) fftSize);
+
+        for (int i = 0; i < fftSize; ++i)
+            signal[(size_t) i] = amplitude * std::sin (juce::MathConstants<double>::twoPi * toneBin * i / fftSize);
+
+        return signal;
+    }
+
+    //Log spaced odd bins, so every tone is periodic in one FFT frame
+    std::vector<int> multitoneBins()
+    {
+        std::vector<int> bins;
+
+        for (auto frequency : { 63.0, 140.0, 310.0, 690.0, 1530.0, 3400.0, 7550.0, 12100.0 })
+            bins.push_back ((int) (frequency * fftSize / sampleRate) | 1);
+
+        return bins;
+    }
+
+    std::vector<double> makeMultitone()
+    {
+        std::vector<double> signal ((size_t) fftSize, 0.0);
+        const auto bins = multitoneBins();
+
+        for (size_t t = 0; t < bins.size(); ++t)
+            for (int i = 0; i < fftSize; ++i)
+                signal[(size_t) i] += 0.1 * std::sin (juce::MathConstants<double>::twoPi * bins[t] * i / fftSize + 0.7 * (double) t);
+
+        return signal;
+    }
+
+    ///Power outside the tone bins relative to the tones
+    double measureMultitone (const std::vector<double>& output)
+    {
+        const auto power = powerSpectrum (output);
+        auto tones = 0.0, rest = 0.0;
+
+        const auto bins = multitoneBins();
+
+        for (size_t bin = 1; bin < power.size(); ++bin)
+        {
+            if (std::find (bins.begin(), bins.end(), (int) bin) != bins.end())
+                tones += power[bin];
+            else
+                rest += power[bin];
+        }
+
+        return toDecibels (rest / tones);
+    }
+
+    ///RMS of (test - reference) relative to the reference, in dB, plus the largest sample error
+    std::pair<double, double> compare (const std::vector<double>& test, const std::vector<double>& reference)
+    {
+        auto errorPower = 0.0, referencePower = 0.0, maxError = 0.0;
+
+        for (size_t i = 0; i < reference.size(); ++i)
+        {
+            const auto error = test[i] - reference[i];
+            errorPower += error * error;
+            referencePower += reference[i] * reference[i];
+            maxError = juce::jmax (maxError, std::abs (error));
+        }
+
+        return { toDecibels (errorPower / juce::jmax (referencePower, 1.0e-30)), maxError };
+    }
+
+    //==============================================================================
+    bool writeGolden (const juce::File& file, const std::vector<double>& signal)
+    {
+        file.deleteFile();
+        std::unique_ptr<juce::OutputStream> stream (file.createOutputStream());
+
+        if (stream == nullptr)
+            return false;
+
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer (wav.createWriterFor (stream.get(), sampleRate, 1, 32, {}, 0));
+
+        if (writer == nullptr)
+            return false;
+
+        stream.release();
+
+        juce::AudioBuffer<float> buffer (1, (int) signal.size());
+
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+            buffer.setSample (0, i, (float) signal[(size_t) i]);
+
+        return writer->writeFromAudioSampleBuffer (buffer, 0, buffer.getNumSamples());
+    }
+
+    bool readGolden (const juce::File& file, std::vector<double>& signal)
+    {
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatReader> reader (wav.createReaderFor (file.createInputStream().release(), true));
+
+        if (reader == nullptr)
+            return false;
+
+        juce::AudioBuffer<float> buffer (1, (int) reader->lengthInSamples);
+        reader->read (&buffer, 0, buffer.getNumSamples(), 0, true, false);
+
+        signal.assign (buffer.getReadPointer (0), buffer.getReadPointer (0) + buffer.getNumSamples());
+        return true;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ArgumentList arguments (argc, argv);
+
+    const auto tolerance = arguments.containsOption ("--tolerance")
+                         ? arguments.getValueForOption ("--tolerance").getDoubleValue() : 1.0e-5;
+
+    //Stepped sweep, odd bins so no harmonic folds exactly onto another
+    std::vector<int> sweepBins;
+
+    for (auto frequency : { 100.0, 250.0, 500.0, 1000.0, 2000.0, 4000.0, 6000.0, 9000.0, 12000.0, 16000.0 })
+        sweepBins.push_back ((int) (frequency * fftSize / sampleRate) | 1);
+
+    const auto multitone = makeMultitone();
+
+    juce::Array<juce::var> results;
+    bool goldenFailed = false;
+
+    std::printf ("%-11s %6s %-6s %10s %10s %12s %14s %10s\n",
+                 "model", "drive", "prec", "THD+N dB", "alias dB", "multitone dB", "vs double dB", "ns/sample");
+
+    for (auto& model : models)
+    {
+        for (auto drive : drives)
+        {
+            for (int precision = 0; precision < 2; ++precision)
+            {
+                const bool isDouble = precision == 1;
+
+                auto worstThd = -300.0, worstAliasing = -300.0, worstDifference = -300.0, cost = 0.0;
+
+                for (auto bin : sweepBins)
+                {
+                    const auto tone = makeTone (bin, 0.5);
+                    const auto reference = render<double> (model.index, drive, tone);
+                    const auto output = isDouble ? reference : render<float> (model.index, drive, tone);
+
+                    const auto result = measureTone (output, bin);
+                    worstThd = juce::jmax (worstThd, result.thdPlusNoiseDb);
+                    worstAliasing = juce::jmax (worstAliasing, result.aliasingDb);
+
+                    if (! isDouble)
+                        worstDifference = juce::jmax (worstDifference, compare (output, reference).first);
+                }
+
+                const auto multitoneOutput = isDouble ? render<double> (model.index, drive, multitone, &cost)
+                                                      : render<float>  (model.index, drive, multitone, &cost);
+                const auto multitoneDb = measureMultitone (multitoneOutput);
+
+                std::printf ("%-11s %6.1f %-6s %10.1f %10.1f %12.1f %14s %10.2f\n",
+                             model.name, drive, isDouble ? "double" : "float", worstThd, worstAliasing, multitoneDb,
+                             isDouble ? "ref" : juce::String (worstDifference, 1).toRawUTF8(), cost);
+
+                auto* entry = new juce::DynamicObject();
+                entry->setProperty ("model", model.name);
+                entry->setProperty ("drive", drive);
+                entry->setProperty ("precision", isDouble ? "double" : "float");
+                entry->setProperty ("thdPlusNoiseDb", worstThd);
+                entry->setProperty ("aliasingDb", worstAliasing);
+                entry->setProperty ("multitoneDb", multitoneDb);
+                entry->setProperty ("nanosecondsPerSample", cost);
+
+                if (! isDouble)
+                    entry->setProperty ("differenceToDoubleDb", worstDifference);
+
+                results.add (juce::var (entry));
+            }
+        }
+
+        //Golden files: one multitone render per model, float precision, 12 dB drive
+        const auto golden = render<float> (model.index, 12.0, multitone);
+        const auto goldenName = juce::String (model.name) + ".wav";
+
+        if (arguments.containsOption ("--write-golden"))
+        {
+            auto folder = juce::File::getCurrentWorkingDirectory().getChildFile (arguments.getValueForOption ("--write-golden"));
+            folder.createDirectory();
+
+            if (! writeGolden (folder.getChildFile (goldenName), golden))
+                std::printf ("could not write %s\n", goldenName.toRawUTF8());
+        }
+
+        if (arguments.containsOption ("--check-golden"))
+        {
+            auto folder = juce::File::getCurrentWorkingDirectory().getChildFile (arguments.getValueForOption ("--check-golden"));
+            std::vector<double> expected;
+
+            if (! readGolden (folder.getChildFile (goldenName), expected) || expected.size() != golden.size())
+            {
+                std::printf ("golden %s: missing or wrong length\n", goldenName.toRawUTF8());
+                goldenFailed = true;
+            }
+            else
+            {
+                const auto difference = compare (golden, expected);
+                const bool passed = difference.second <= tolerance;
+
+                std::printf ("golden %-11s max error %.3g (%.1f dB) %s\n", model.name, difference.second, difference.first,
+                             passed ? "ok" : "FAILED");
+
+                goldenFailed = goldenFailed || ! passed;
+            }
+        }
+    }
+
+    if (arguments.containsOption ("--json"))
+    {
+        auto file = juce::File::getCurrentWorkingDirectory().getChildFile (arguments.getValueForOption ("--json"));
+        file.replaceWithText (juce::JSON::toString (juce::var (results)));
+    }
+
+    return goldenFailed ? 1 : 0;
+}
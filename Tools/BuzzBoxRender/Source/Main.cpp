@@ -0,0 +1,605 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 19 Oct 2026 6:48:05pm
+    Author:  Alperen Kurbetci
+
+    Batch offline renderer, runs BuzzBoxAudioProcessor over many files on a headless box.
+
+    Every input file is rendered once per preset. A preset is an XML file in the plugin's
+    own state format (the PARAMETERS tree, optionally with neuralModelPath and
+    impulseResponsePath attributes, relative paths are taken from the preset's folder).
+
+    Jobs are spread over a work stealing pool, every worker owns one processor. Input is
+    memory mapped when the format allows it (WAV, AIFF), otherwise read ahead on a
+    background thread, and the output goes through a double buffered ThreadedWriter, so
+    the workers only ever wait on the DSP.
+
+    BuzzBoxRender --output=dir [--preset=a.xml,b.xml] [--files=list.txt] [--threads=N]
+                  [--block=4096] [--bits=24] [--tail] [--trace=dir] [input files...]
+
+    Output files are named <input>_<preset>.wav and are aligned with the input (the plugin's
+    latency is removed), each one is reported with its realtime factor.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <deque>
+#include <numeric>
+#include "../../../Source/PluginProcessor.h"
+
+namespace
+{
+    //Memory mapped reads never wait, the others read this far ahead
+    constexpr int readAheadSamples = 1 << 16;
+    constexpr int writeBufferSamples = 1 << 17;
+    constexpr int loadTimeoutMs = 30000;
+
+    struct Settings
+    {
+        juce::File outputFolder;
+        int blockSize = 4096;
+        int bitsPerSample = 24;
+        bool renderTail = false;
+        juce::File traceFolder;
+    };
+
+    struct Preset
+    {
+        juce::String name;
+        juce::MemoryBlock state;
+    };
+
+    struct RenderJob
+    {
+        juce::File input;
+        const Preset* preset = nullptr;
+        juce::int64 lengthInSamples = 0;
+
+        //Filled in by the worker
+        bool succeeded = false;
+        juce::String message;
+        double audioSeconds = 0.0;
+        double wallSeconds = 0.0;
+    };
+
+    //==============================================================================
+    ///Workers print from their own threads, one line at a time
+    class Console
+    {
+    public:
+        void print (const juce::String& line)
+        {
+            const juce::ScopedLock sl (_lock);
+            std::cout << line << std::endl;
+        }
+
+    private:
+        juce::CriticalSection _lock;
+    };
+
+    //==============================================================================
+    /*
+     One job queue per worker. A worker takes from the front of its own queue and, once that is
+     empty, steals from the back of the others, so a worker stuck on a long file does not hold
+     back the short ones queued behind it.
+     */
+    class WorkStealingQueues
+    {
+    public:
+        explicit WorkStealingQueues (int numWorkers) : _queues ((size_t) numWorkers) {}
+
+        void push (int worker, int job)
+        {
+            auto& queue = _queues[(size_t) worker];
+            const juce::ScopedLock sl (queue.lock);
+            queue.jobs.push_back (job);
+        }
+
+        bool pop (int worker, int& job)
+        {
+            {
+                auto& own = _queues[(size_t) worker];
+                const juce::ScopedLock sl (own.lock);
+
+                if (! own.jobs.empty())
+                {
+                    job = own.jobs.front();
+                    own.jobs.pop_front();
+                    return true;
+                }
+            }
+
+            for (size_t i = 1; i < _queues.size(); ++i)
+            {
+                auto& victim = _queues[((size_t) worker + i) % _queues.size()];
+                const juce::ScopedLock sl (victim.lock);
+
+                if (! victim.jobs.empty())
+                {
+                    job = victim.jobs.back();
+                    victim.jobs.pop_back();
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+    private:
+        struct Queue
+        {
+            juce::CriticalSection lock;
+            std::deque<int> jobs;
+        };
+
+        std::vector<Queue> _queues;
+    };
+
+    //==============================================================================
+    class RenderWorker : public juce::Thread
+    {
+    public:
+        RenderWorker (int index, const Settings& settings, std::vector<RenderJob>& jobs,
+                      WorkStealingQueues& queues, Console& console)
+            : juce::Thread ("BuzzBox Render " + juce::String (index)),
+              _index (index), _settings (settings), _jobs (jobs), _queues (queues), _console (console),
+              _ioThread ("BuzzBox Render IO " + juce::String (index))
+        {
+            _formats.registerBasicFormats();
+            _ioThread.startThread();
+        }
+
+        ~RenderWorker() override
+        {
+            stopThread (-1);
+            _ioThread.stopThread (-1);
+        }
+
+        void run() override
+        {
+            int jobIndex = 0;
+
+            while (! threadShouldExit() && _queues.pop (_index, jobIndex))
+            {
+                auto& job = _jobs[(size_t) jobIndex];
+
+                const auto start = juce::Time::getMillisecondCounterHiRes();
+                job.succeeded = render (job);
+                job.wallSeconds = (juce::Time::getMillisecondCounterHiRes() - start) * 0.001;
+
+                auto line = job.input.getFileName() + " [" + job.preset->name + "] ";
+
+                if (job.succeeded)
+                    line << juce::String (job.audioSeconds, 1) << " s in " << juce::String (job.wallSeconds, 2)
+                         << " s, " << juce::String (job.audioSeconds / juce::jmax (job.wallSeconds, 1.0e-9), 1) << "x realtime";
+                else
+                    line << "FAILED: " << job.message;
+
+                _console.print (line);
+            }
+        }
+
+    private:
+        //==============================================================================
+        std::unique_ptr<juce::AudioFormatReader> openReader (const juce::File& file)
+        {
+            auto* format = _formats.findFormatForFileExtension (file.getFileExtension());
+
+            if (format == nullptr)
+                return {};
+
+            std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped (format->createMemoryMappedReader (file));
+
+            if (mapped != nullptr && mapped->mapEntireFile())
+                return mapped;
+
+            std::unique_ptr<juce::AudioFormatReader> reader (_formats.createReaderFor (file));
+
+            if (reader == nullptr)
+                return {};
+
+            //Compressed formats are decoded ahead on the io thread, the worker never blocks on them
+            auto buffered = std::make_unique<juce::BufferingAudioReader> (reader.release(), _ioThread, readAheadSamples);
+            buffered->setReadTimeout (loadTimeoutMs);
+            return buffered;
+        }
+
+        /*
+         A new preset gets a new processor, so nothing loaded by the previous one (a model, an IR,
+         a load error) carries over. Bus layout and sample rate only change when the file needs it.
+         The files named by the preset are built in the background, silent blocks are run until the
+         processor has picked them up, then prepareToPlay() clears everything those blocks left behind.
+         */
+        bool configure (const RenderJob& job, double sampleRate, int numChannels, juce::String& error)
+        {
+            const auto presetChanged = job.preset != _loadedPreset;
+
+            if (presetChanged)
+            {
+                _processor = std::make_unique<BuzzBoxAudioProcessor>();
+                _processor->setNonRealtime (true);
+                _loadedPreset = nullptr;
+
+                //One trace per processor, written until the next preset replaces it
+                if (_settings.traceFolder != juce::File())
+                    _processor->startTracing (_settings.traceFolder.getChildFile ("worker " + juce::String (_index) + " - "
+                                                                                  + juce::String (++_numTraces) + ".json"));
+            }
+
+            const auto layoutChanged = numChannels != _processor->getTotalNumOutputChannels();
+
+            if (layoutChanged)
+            {
+                const auto set = juce::AudioChannelSet::canonicalChannelSet (numChannels);
+
+                // Only the main buses change, the sidechain input stays off
+                auto layout = _processor->getBusesLayout();
+                layout.inputBuses.getReference (0) = set;
+                layout.outputBuses.getReference (0) = set;
+
+                for (int bus = 1; bus < layout.inputBuses.size(); ++bus)
+                    layout.inputBuses.getReference (bus) = juce::AudioChannelSet::disabled();
+
+                if (! _processor->setBusesLayout (layout))
+                {
+                    error = "Unsupported channel count " + juce::String (numChannels);
+                    return false;
+                }
+            }
+
+            _processor->setRateAndBufferSizeDetails (sampleRate, _settings.blockSize);
+            _processor->prepareToPlay (sampleRate, _settings.blockSize);
+            _buffer.setSize (numChannels, _settings.blockSize, false, false, true);
+
+            if (presetChanged && job.preset->state.getSize() > 0)
+                _processor->setStateInformation (job.preset->state.getData(), (int) job.preset->state.getSize());
+
+            if (presetChanged || layoutChanged || sampleRate != _preparedRate)
+            {
+                juce::MidiBuffer midi;
+                const auto deadline = juce::Time::getMillisecondCounter() + (juce::uint32) loadTimeoutMs;
+
+                while (_processor->isLoadingFiles())
+                {
+                    if (juce::Time::getMillisecondCounter() > deadline)
+                    {
+                        error = "Timed out loading the preset files";
+                        return false;
+                    }
+
+                    _buffer.clear();
+                    _processor->processBlock (_buffer, midi);
+                    juce::Thread::sleep (2);
+                }
+
+                error = _processor->getLoadError();
+
+                if (error.isNotEmpty())
+                    return false;
+
+                _processor->prepareToPlay (sampleRate, _settings.blockSize);
+            }
+
+            _loadedPreset = job.preset;
+            _preparedRate = sampleRate;
+            return true;
+        }
+
+        //==============================================================================
+        bool render (RenderJob& job)
+        {
+            auto reader = openReader (job.input);
+
+            if (reader == nullptr)
+            {
+                job.message = "Can not read the file";
+                return false;
+            }
+
+            const auto sampleRate = reader->sampleRate;
+            const auto numChannels = (int) reader->numChannels;
+
+            if (! configure (job, sampleRate, numChannels, job.message))
+                return false;
+
+            auto outputFile = _settings.outputFolder.getChildFile (job.input.getFileNameWithoutExtension()
+                                                                   + "_" + job.preset->name + ".wav");
+            juce::TemporaryFile temporary (outputFile);
+
+            {
+                std::unique_ptr<juce::FileOutputStream> stream (temporary.getFile().createOutputStream());
+                std::unique_ptr<juce::AudioFormatWriter> writer;
+
+                if (stream != nullptr)
+                    writer.reset (_wav.createWriterFor (stream.get(), sampleRate, (unsigned int) numChannels,
+                                                        _settings.bitsPerSample, {}, 0));
+
+                if (writer == nullptr)
+                {
+                    job.message = "Can not write " + outputFile.getFullPathName();
+                    return false;
+                }
+
+                stream.release();
+
+                //Flushed to disk on the io thread, the destructor writes whatever is left
+                juce::AudioFormatWriter::ThreadedWriter threadedWriter (writer.release(), _ioThread, writeBufferSamples);
+
+                const auto tailSamples = _settings.renderTail
+                                       ? (juce::int64) std::ceil (_processor->getTailLengthSeconds() * sampleRate) : 0;
+                const auto totalSamples = reader->lengthInSamples + tailSamples;
+
+                //The first latency samples out of the processor are dropped, so the output lines up with the input
+                const auto latency = (juce::int64) _processor->getLatencySamples();
+                const float* channels[2] = {};
+
+                juce::MidiBuffer midi;
+
+                for (juce::int64 position = 0; position < totalSamples + latency; position += _settings.blockSize)
+                {
+                    if (threadShouldExit())
+                    {
+                        job.message = "Cancelled";
+                        return false;
+                    }
+
+                    const auto count = (int) juce::jmin ((juce::int64) _settings.blockSize, totalSamples + latency - position);
+
+                    //Past the end of the file the reader fills in silence, that is the tail
+                    _buffer.setSize (numChannels, count, true, false, true);
+                    reader->read (&_buffer, 0, count, position, true, true);
+
+                    _processor->processBlock (_buffer, midi);
+
+                    const auto skip = (int) juce::jlimit ((juce::int64) 0, (juce::int64) count, latency - position);
+
+                    if (skip == count)
+                        continue;
+
+                    for (int channel = 0; channel < numChannels; ++channel)
+                        channels[channel] = _buffer.getReadPointer (channel, skip);
+
+                    while (! threadedWriter.write (channels, count - skip))
+                        juce::Thread::sleep (1);
+                }
+
+                job.audioSeconds = (double) totalSamples / sampleRate;
+            }
+
+            if (! temporary.overwriteTargetFileWithTemporary())
+            {
+                job.message = "Can not replace " + outputFile.getFullPathName();
+                return false;
+            }
+
+            return true;
+        }
+
+        const int _index;
+        const Settings& _settings;
+        std::vector<RenderJob>& _jobs;
+        WorkStealingQueues& _queues;
+        Console& _console;
+
+        //Read ahead and write behind for this worker's files, one per worker so disk io scales with the workers
+        juce::TimeSliceThread _ioThread;
+
+        std::unique_ptr<BuzzBoxAudioProcessor> _processor;
+        int _numTraces = 0;
+        juce::AudioFormatManager _formats;
+        juce::WavAudioFormat _wav;
+        juce::AudioBuffer<float> _buffer;
+
+        const Preset* _loadedPreset = nullptr;
+        double _preparedRate = 0.0;
+    };
+
+    //==============================================================================
+    juce::StringArray splitList (const juce::String& list)
+    {
+        juce::StringArray items;
+        items.addTokens (list, ",", "\"");
+        items.trim();
+        items.removeEmptyStrings();
+        return items;
+    }
+
+    ///Reads a preset, model and IR paths are made absolute so the workers do not depend on the working directory
+    bool loadPreset (const juce::File& file, Preset& preset, juce::String& error)
+    {
+        auto xml = juce::parseXML (file);
+
+        if (xml == nullptr || ! xml->hasTagName ("PARAMETERS"))
+        {
+            error = file.getFullPathName() + " is not a BuzzBox preset";
+            return false;
+        }
+
+        for (auto* attribute : { &neuralModelPathID, &impulseResponsePathID })
+        {
+            auto path = xml->getStringAttribute (*attribute);
+
+            if (path.isNotEmpty() && ! juce::File::isAbsolutePath (path))
+                xml->setAttribute (*attribute, file.getParentDirectory().getChildFile (path).getFullPathName());
+        }
+
+        preset.name = file.getFileNameWithoutExtension();
+        juce::AudioProcessor::copyXmlToBinary (*xml, preset.state);
+        return true;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    //The processor's parameter tree expects a message manager to exist, the loop itself never runs
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList arguments (argc, argv);
+
+    if (! arguments.containsOption ("--output"))
+    {
+        std::cout << "BuzzBoxRender --output=dir [--preset=a.xml,b.xml] [--files=list.txt] [--threads=N]" << std::endl
+                  << "              [--block=4096] [--bits=24] [--tail] [--trace=dir] [input files...]" << std::endl;
+        return 1;
+    }
+
+    auto workingDirectory = juce::File::getCurrentWorkingDirectory();
+
+    Settings settings;
+    settings.outputFolder = workingDirectory.getChildFile (arguments.getValueForOption ("--output"));
+    settings.renderTail = arguments.containsOption ("--tail");
+
+    if (arguments.containsOption ("--trace"))
+        settings.traceFolder = workingDirectory.getChildFile (arguments.getValueForOption ("--trace"));
+
+    if (arguments.containsOption ("--block"))
+        settings.blockSize = juce::jlimit (64, 1 << 16, arguments.getValueForOption ("--block").getIntValue());
+
+    if (arguments.containsOption ("--bits"))
+        settings.bitsPerSample = arguments.getValueForOption ("--bits").getIntValue();
+
+    if (settings.bitsPerSample != 16 && settings.bitsPerSample != 24 && settings.bitsPerSample != 32)
+    {
+        std::cout << "--bits must be 16, 24 or 32" << std::endl;
+        return 1;
+    }
+
+    if (! settings.outputFolder.createDirectory())
+    {
+        std::cout << "Can not create " << settings.outputFolder.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    //Presets, without any the plugin defaults are rendered
+    std::vector<Preset> presets;
+
+    for (auto& path : splitList (arguments.getValueForOption ("--preset")))
+    {
+        Preset preset;
+        juce::String error;
+
+        if (! loadPreset (workingDirectory.getChildFile (path), preset, error))
+        {
+            std::cout << error << std::endl;
+            return 1;
+        }
+
+        presets.push_back (std::move (preset));
+    }
+
+    if (presets.empty())
+        presets.push_back ({ "default", {} });
+
+    //Inputs from the list file and from the command line
+    juce::StringArray paths;
+
+    if (arguments.containsOption ("--files"))
+    {
+        auto listFile = workingDirectory.getChildFile (arguments.getValueForOption ("--files"));
+        paths.addLines (listFile.loadFileAsString());
+
+        for (auto& path : paths)
+            path = listFile.getParentDirectory().getChildFile (path.trim()).getFullPathName();
+    }
+
+    for (auto& argument : arguments.arguments)
+        if (! argument.isOption())
+            paths.add (argument.resolveAsFile().getFullPathName());
+
+    paths.removeEmptyStrings();
+
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+
+    std::vector<RenderJob> jobs;
+
+    for (auto& path : paths)
+    {
+        juce::File input (path);
+        std::unique_ptr<juce::AudioFormatReader> reader (formats.createReaderFor (input));
+
+        if (reader == nullptr)
+        {
+            std::cout << "Skipping " << path << ", not a readable audio file" << std::endl;
+            continue;
+        }
+
+        for (auto& preset : presets)
+        {
+            RenderJob job;
+            job.input = input;
+            job.preset = &preset;
+            job.lengthInSamples = reader->lengthInSamples;
+            jobs.push_back (job);
+        }
+    }
+
+    if (jobs.empty())
+    {
+        std::cout << "Nothing to render" << std::endl;
+        return 1;
+    }
+
+    const auto numWorkers = juce::jlimit (1, (int) jobs.size(), arguments.containsOption ("--threads")
+                                                                ? arguments.getValueForOption ("--threads").getIntValue()
+                                                                : juce::SystemStats::getNumCpus());
+
+    /*
+     Grouped by preset so a worker rarely has to rebuild its processor, longest files first within
+     a preset, dealt round robin so every worker starts with a similar load
+     */
+    std::vector<int> order (jobs.size());
+    std::iota (order.begin(), order.end(), 0);
+    std::stable_sort (order.begin(), order.end(), [&jobs] (int a, int b)
+    {
+        const auto& first = jobs[(size_t) a];
+        const auto& second = jobs[(size_t) b];
+
+        if (first.preset != second.preset)
+            return first.preset < second.preset;
+
+        return first.lengthInSamples > second.lengthInSamples;
+    });
+
+    WorkStealingQueues queues (numWorkers);
+
+    for (size_t i = 0; i < order.size(); ++i)
+        queues.push ((int) (i % (size_t) numWorkers), order[i]);
+
+    Console console;
+
+    std::vector<std::unique_ptr<RenderWorker>> workers;
+
+    for (int i = 0; i < numWorkers; ++i)
+        workers.push_back (std::make_unique<RenderWorker> (i, settings, jobs, queues, console));
+
+    const auto start = juce::Time::getMillisecondCounterHiRes();
+
+    for (auto& worker : workers)
+        worker->startThread();
+
+    for (auto& worker : workers)
+        worker->waitForThreadToExit (-1);
+
+    const auto wallSeconds = (juce::Time::getMillisecondCounterHiRes() - start) * 0.001;
+
+    workers.clear();
+
+    double audioSeconds = 0.0;
+    int failures = 0;
+
+    for (auto& job : jobs)
+    {
+        audioSeconds += job.audioSeconds;
+        failures += job.succeeded ? 0 : 1;
+    }
+
+    std::cout << jobs.size() - (size_t) failures << " of " << jobs.size() << " renders done on " << numWorkers << " threads, "
+              << juce::String (audioSeconds, 1) << " s of audio in " << juce::String (wallSeconds, 2) << " s ("
+              << juce::String (audioSeconds / juce::jmax (wallSeconds, 1.0e-9), 1) << "x realtime)" << std::endl;
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,388 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 20 Oct 2026 1:05:44am
+    Author:  Alperen Kurbetci
+
+    Stress host for BuzzBoxAudioProcessor, looks for the spikes and the real-time
+    violations an average benchmark hides.
+
+    Every round prepares the processor at a random sample rate and block size (and now and
+    then switches it between realtime and offline), then runs blocks of random length: single
+    samples, odd sizes and sizes above the prepared maximum. Random parameters, the models
+    included, are automated from the processing thread before every block, the way hosts do.
+    Main input and sidechain switch between program material, hot square waves, denormal
+    tails, NaN / Inf bursts and silence.
+
+    It reports the worst and the 99.9th percentile cost per sample and per block (as a share
+    of the block's real-time budget), and fails with exit code 1 when
+      - the processing thread allocates or frees memory while automating or processing
+      - any output sample is NaN or Inf
+
+    Allocations are caught through malloc on Linux and through operator new elsewhere. Before
+    the first block of every round each parameter is set once outside the check, the way any
+    host session has long done before the stress starts. That first processBlock() after
+    prepareToPlay() is checked like every other, only its time is left out of the figures.
+
+    BuzzBoxStress [--rounds=40] [--blocks=2000] [--seed=1] [--json=results.json]
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../../Source/PluginProcessor.h"
+
+namespace
+{
+    //Set around the processing calls, only that thread's allocations count
+    thread_local bool trackAllocations = false;
+    std::atomic<juce::int64> processAllocations { 0 };
+
+    inline void countAllocation() noexcept
+    {
+        if (trackAllocations)
+            processAllocations.fetch_add (1, std::memory_order_relaxed);
+    }
+}
+
+#if JUCE_LINUX
+//operator new, juce::HeapBlock and the C++ runtime all end up here
+extern "C"
+{
+    void* __libc_malloc (size_t);
+    void* __libc_calloc (size_t, size_t);
+    void* __libc_realloc (void*, size_t);
+    void* __libc_memalign (size_t, size_t);
+    void  __libc_free (void*);
+
+    void* malloc (size_t size) noexcept                   { countAllocation(); return __libc_malloc (size); }
+    void* calloc (size_t count, size_t size) noexcept     { countAllocation(); return __libc_calloc (count, size); }
+    void* realloc (void* pointer, size_t size) noexcept   { countAllocation(); return __libc_realloc (pointer, size); }
+    void* memalign (size_t alignment, size_t size) noexcept { countAllocation(); return __libc_memalign (alignment, size); }
+    void* aligned_alloc (size_t alignment, size_t size) noexcept { countAllocation(); return __libc_memalign (alignment, size); }
+
+    int posix_memalign (void** result, size_t alignment, size_t size) noexcept
+    {
+        countAllocation();
+        *result = __libc_memalign (alignment, size);
+        return *result != nullptr ? 0 : ENOMEM;
+    }
+
+    void free (void* pointer) noexcept
+    {
+        if (pointer != nullptr)
+            countAllocation();
+
+        __libc_free (pointer);
+    }
+}
+#else
+//The over-aligned forms are left alone, nothing in the chain uses them
+void* operator new (std::size_t size)
+{
+    countAllocation();
+
+    if (auto* pointer = std::malloc (size == 0 ? 1 : size))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[] (std::size_t size)                  { return operator new (size); }
+void operator delete (void* pointer) noexcept            { if (pointer != nullptr) countAllocation(); std::free (pointer); }
+void operator delete[] (void* pointer) noexcept          { operator delete (pointer); }
+void operator delete (void* pointer, std::size_t) noexcept   { operator delete (pointer); }
+void operator delete[] (void* pointer, std::size_t) noexcept { operator delete (pointer); }
+#endif
+
+namespace
+{
+    const double sampleRates[] = { 22050.0, 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 };
+    const int blockSizes[] = { 16, 32, 64, 100, 128, 256, 441, 512, 1000, 1024, 2048, 4096 };
+
+    constexpr int maxPreparedBlock = 4096;
+    constexpr int maxBlock = 3 * maxPreparedBlock + 7;
+    constexpr int numMainChannels = 2;
+    constexpr int numSidechainChannels = 2;
+
+    enum class Signal
+    {
+        cProgram,
+        cHotSquare,
+        cDenormal,
+        cNonFinite,
+        cSilence
+    };
+
+    struct Settings
+    {
+        int rounds = 40;
+        int blocksPerRound = 2000;
+        juce::int64 seed = 1;
+    };
+
+    struct Results
+    {
+        std::vector<double> nanosecondsPerSample;
+        std::vector<double> budgetUsed;
+        juce::int64 blocks = 0;
+        juce::int64 samples = 0;
+        juce::int64 allocations = 0;
+        juce::int64 nonFiniteBlocks = 0;
+    };
+
+    //==============================================================================
+    ///Host block sizes: mostly the prepared one, but also single samples, odd sizes and more than announced
+    int pickBlockSize (juce::Random& random, int preparedBlock)
+    {
+        switch (random.nextInt (8))
+        {
+            case 0:  return 1;
+            case 1:  return 1 + random.nextInt (16);
+            case 2:  return 1 + 2 * random.nextInt (juce::jmax (1, preparedBlock / 2));
+            case 3:  return preparedBlock + 1 + random.nextInt (juce::jmin (maxBlock - preparedBlock, 2 * preparedBlock + 7));
+            case 4:  return 1 + random.nextInt (preparedBlock);
+            default: return preparedBlock;
+        }
+    }
+
+    void fillSignal (juce::Random& random, Signal signal, float* samples, int numSamples, double& phase)
+    {
+        switch (signal)
+        {
+            case Signal::cProgram:
+            {
+                const auto level = random.nextFloat();
+
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    phase += 0.031;
+                    samples[i] = level * (0.7f * (float) std::sin (phase) + 0.3f * (random.nextFloat() * 2.0f - 1.0f));
+                }
+
+                break;
+            }
+
+            case Signal::cHotSquare:
+            {
+                const auto level = 1.0f + 3.0f * random.nextFloat();
+
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    phase += 0.013;
+                    samples[i] = std::sin (phase) >= 0.0 ? level : -level;
+                }
+
+                break;
+            }
+
+            //Tails decaying through the subnormal range, the worst case for filters without flush to zero
+            case Signal::cDenormal:
+            {
+                auto value = std::numeric_limits<float>::min() * (random.nextFloat() * 4.0f - 2.0f);
+
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    samples[i] = value;
+                    value *= 0.9f;
+
+                    if (value == 0.0f)
+                        value = std::numeric_limits<float>::min() * (random.nextBool() ? 1.0f : -1.0f);
+                }
+
+                break;
+            }
+
+            case Signal::cNonFinite:
+            {
+                fillSignal (random, Signal::cProgram, samples, numSamples, phase);
+
+                const float values[] = { std::numeric_limits<float>::quiet_NaN(),
+                                         std::numeric_limits<float>::infinity(),
+                                        -std::numeric_limits<float>::infinity() };
+
+                for (int burst = 1 + random.nextInt (4); --burst >= 0;)
+                    samples[random.nextInt (numSamples)] = values[random.nextInt (3)];
+
+                break;
+            }
+
+            case Signal::cSilence:
+                juce::FloatVectorOperations::clear (samples, numSamples);
+                break;
+        }
+    }
+
+    double getPercentile (std::vector<double>& values, double fraction)
+    {
+        if (values.empty())
+            return 0.0;
+
+        const auto index = (size_t) std::floor (fraction * (double) (values.size() - 1));
+        std::nth_element (values.begin(), values.begin() + (std::ptrdiff_t) index, values.end());
+        return values[index];
+    }
+
+    //==============================================================================
+    void runRound (BuzzBoxAudioProcessor& processor, juce::Random& random, const Settings& settings,
+                   juce::AudioBuffer<float>& storage, Results& results)
+    {
+        const auto sampleRate = sampleRates[random.nextInt ((int) std::size (sampleRates))];
+        const auto preparedBlock = blockSizes[random.nextInt ((int) std::size (blockSizes))];
+
+        processor.releaseResources();
+        processor.setNonRealtime (random.nextInt (4) == 0);
+        processor.setRateAndBufferSizeDetails (sampleRate, preparedBlock);
+        processor.prepareToPlay (sampleRate, preparedBlock);
+
+        auto& parameters = processor.getParameters();
+        const auto ticksPerSecond = (double) juce::Time::getHighResolutionTicksPerSecond();
+
+        juce::MidiBuffer midi;
+        double phases[numMainChannels + numSidechainChannels] = {};
+
+        for (int block = 0; block < settings.blocksPerRound; ++block)
+        {
+            const auto numSamples = block == 0 ? preparedBlock : pickBlockSize (random, preparedBlock);
+
+            //A bounce starting or stopping without a new prepareToPlay()
+            if (random.nextInt (200) == 0)
+                processor.setNonRealtime (! processor.isNonRealtime());
+
+            const auto mainSignal = static_cast<Signal> (random.nextInt (5));
+            const auto sidechainSignal = static_cast<Signal> (random.nextInt (5));
+
+            for (int channel = 0; channel < storage.getNumChannels(); ++channel)
+                fillSignal (random, channel < numMainChannels ? mainSignal : sidechainSignal,
+                            storage.getWritePointer (channel), numSamples, phases[channel]);
+
+            juce::AudioBuffer<float> buffer (storage.getArrayOfWritePointers(), storage.getNumChannels(), 0, numSamples);
+
+            //Picked up front so the random generator stays out of the measurement
+            int automated[64];
+            float values[64];
+            const auto numAutomated = block == 0 ? juce::jmin (64, parameters.size()) : random.nextInt (juce::jmin (64, parameters.size()) + 1);
+
+            for (int i = 0; i < numAutomated; ++i)
+            {
+                automated[i] = block == 0 ? i : random.nextInt (parameters.size());
+                values[i] = random.nextFloat();
+            }
+
+            //The first pass touches every parameter once outside the check, the callback after it is checked like any other
+            if (block == 0)
+                for (int i = 0; i < numAutomated; ++i)
+                    parameters.getUnchecked (automated[i])->setValueNotifyingHost (values[i]);
+
+            trackAllocations = true;
+            const auto start = juce::Time::getHighResolutionTicks();
+
+            for (int i = 0; block > 0 && i < numAutomated; ++i)
+                parameters.getUnchecked (automated[i])->setValueNotifyingHost (values[i]);
+
+            processor.processBlock (buffer, midi);
+
+            const auto ticks = juce::Time::getHighResolutionTicks() - start;
+            trackAllocations = false;
+
+            //Its time is the cold start after prepareToPlay(), not what the chain needs per block
+            if (block > 0)
+            {
+                const auto seconds = (double) ticks / ticksPerSecond;
+                results.nanosecondsPerSample.push_back (seconds * 1.0e9 / numSamples);
+                results.budgetUsed.push_back (seconds * sampleRate / numSamples);
+                results.blocks += 1;
+                results.samples += numSamples;
+            }
+
+            auto finite = true;
+
+            for (int channel = 0; channel < numMainChannels; ++channel)
+            {
+                const auto* samples = buffer.getReadPointer (channel);
+
+                for (int i = 0; i < numSamples; ++i)
+                    finite = finite && std::isfinite (samples[i]);
+            }
+
+            if (! finite && results.nonFiniteBlocks++ < 10)
+                std::cout << "Non-finite output: " << juce::String (sampleRate, 0) << " Hz, prepared " << preparedBlock
+                          << ", block " << numSamples << ", input " << (int) mainSignal << std::endl;
+        }
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    //The processor's parameter tree expects a message manager to exist, the loop itself never runs
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList arguments (argc, argv);
+
+    Settings settings;
+
+    if (arguments.containsOption ("--rounds"))
+        settings.rounds = juce::jmax (1, arguments.getValueForOption ("--rounds").getIntValue());
+
+    if (arguments.containsOption ("--blocks"))
+        settings.blocksPerRound = juce::jmax (2, arguments.getValueForOption ("--blocks").getIntValue());
+
+    if (arguments.containsOption ("--seed"))
+        settings.seed = arguments.getValueForOption ("--seed").getLargeIntValue();
+
+    BuzzBoxAudioProcessor processor;
+
+    //Sidechain on, so its envelope is stressed too
+    auto layout = processor.getBusesLayout();
+    layout.inputBuses.getReference (1) = juce::AudioChannelSet::stereo();
+
+    if (! processor.setBusesLayout (layout))
+    {
+        std::cout << "Can not enable the sidechain" << std::endl;
+        return 1;
+    }
+
+    juce::AudioBuffer<float> storage (numMainChannels + numSidechainChannels, maxBlock);
+    juce::Random random (settings.seed);
+
+    Results results;
+    results.nanosecondsPerSample.reserve ((size_t) settings.rounds * (size_t) settings.blocksPerRound);
+    results.budgetUsed.reserve ((size_t) settings.rounds * (size_t) settings.blocksPerRound);
+
+    for (int round = 0; round < settings.rounds; ++round)
+        runRound (processor, random, settings, storage, results);
+
+    results.allocations = processAllocations.load();
+
+    const auto worstPerSample = getPercentile (results.nanosecondsPerSample, 1.0);
+    const auto p999PerSample  = getPercentile (results.nanosecondsPerSample, 0.999);
+    const auto worstBudget    = getPercentile (results.budgetUsed, 1.0);
+    const auto p999Budget     = getPercentile (results.budgetUsed, 0.999);
+
+    std::cout << results.blocks << " blocks, " << results.samples << " samples in " << settings.rounds << " rounds (seed "
+              << settings.seed << ")" << std::endl
+              << "ns per sample:   worst " << juce::String (worstPerSample, 1) << ", p99.9 " << juce::String (p999PerSample, 1) << std::endl
+              << "real-time share: worst " << juce::String (worstBudget * 100.0, 2) << " %, p99.9 " << juce::String (p999Budget * 100.0, 2) << " %" << std::endl
+              << "allocations on the processing thread: " << results.allocations << std::endl
+              << "blocks with non-finite output: " << results.nonFiniteBlocks << std::endl;
+
+    if (arguments.containsOption ("--json"))
+    {
+        auto* object = new juce::DynamicObject();
+        object->setProperty ("seed", settings.seed);
+        object->setProperty ("blocks", results.blocks);
+        object->setProperty ("samples", results.samples);
+        object->setProperty ("worstNanosecondsPerSample", worstPerSample);
+        object->setProperty ("p999NanosecondsPerSample", p999PerSample);
+        object->setProperty ("worstRealtimeShare", worstBudget);
+        object->setProperty ("p999RealtimeShare", p999Budget);
+        object->setProperty ("allocations", results.allocations);
+        object->setProperty ("nonFiniteBlocks", results.nonFiniteBlocks);
+
+        auto file = juce::File::getCurrentWorkingDirectory().getChildFile (arguments.getValueForOption ("--json"));
+        file.replaceWithText (juce::JSON::toString (juce::var (object)));
+    }
+
+    return results.allocations == 0 && results.nonFiniteBlocks == 0 ? 0 : 1;
+}